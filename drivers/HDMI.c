@@ -10,6 +10,7 @@
 #include "pico/multicore.h"
 #include "hardware/clocks.h"
 #include "hardware/irq.h"
+#include "hardware/structs/m33.h"
 
 // Globals expected by the driver
 int graphics_buffer_width = 320;
@@ -105,14 +106,45 @@ static int dma_chan;
 static int dma_chan_pal_conv_ctrl;
 static int dma_chan_pal_conv;
 
-//DMA буферы
-//основные строчные данные
-static uint32_t* dma_lines[2] = { NULL,NULL };
-static uint32_t* DMA_BUF_ADDR[2];
-
 //ДМА палитра для конвертации
-//в хвосте этой памяти выделяется dma_data
-alignas(4096) uint32_t conv_color[1224];
+alignas(4096) uint32_t conv_color[1024];
+
+// Scanout is driven by a list of DMA control blocks walked by
+// dma_chan_ctrl, one block per pair of identical lines, so lines are
+// queued without the CPU. A last block points dma_chan_ctrl back at the
+// start, so the list repeats by itself. Blanking and vsync lines come
+// from prebuilt templates. The active rows go through two groups of
+// HDMI_ROWS_PER_IRQ line buffers: the last block of each group raises an
+// interrupt, which converts the group after the next one into the buffers
+// just sent. Apart from those, only the end of the image and the end of
+// the frame interrupt.
+#define HDMI_LINE_BYTES   (400)     // one byte per two pixels
+#define HDMI_IMAGE_OFFSET (72)      // hsync and back porch before the image
+#define HDMI_FRAME_LINES  (525)
+#define HDMI_FRAME_BLOCKS ((HDMI_FRAME_LINES + 1) / 2)
+#define HDMI_ROWS_PER_IRQ (4)
+#define HDMI_FRAME_IRQ    (HDMI_FRAME_BLOCKS - 6)  // time to convert two groups
+
+// In the order of the read_addr, write_addr, transfer_count, ctrl_trig
+// registers, so each block also sets up dma_chan, including its interrupt
+typedef struct {
+    const volatile void* read_addr;
+    volatile void* write_addr;
+    uint32_t count;
+    uint32_t ctrl;
+} hdmi_block_t;
+
+static hdmi_block_t hdmi_frame[HDMI_FRAME_BLOCKS + 1];  // and the rewind
+static const hdmi_block_t* hdmi_frame_start = hdmi_frame;
+static int hdmi_active_blocks;
+
+static alignas(4) uint8_t hdmi_active_lines[2][HDMI_ROWS_PER_IRQ][2 * HDMI_LINE_BYTES];
+
+// Line buffer of image row y
+#define HDMI_ROW_LINES(y) (hdmi_active_lines[((y) / HDMI_ROWS_PER_IRQ) & 1][(y) % HDMI_ROWS_PER_IRQ])
+
+static alignas(4) uint8_t hdmi_blank_lines[2 * HDMI_LINE_BYTES];
+static alignas(4) uint8_t hdmi_vsync_lines[2 * HDMI_LINE_BYTES];
 
 //индекс, проверяющий зависание
 static uint32_t irq_inx = 0;
@@ -226,128 +258,198 @@ static void pio_set_x(PIO pio, const int sm, uint32_t v) {
 }
 
 volatile uint32_t hdmi_irq_count = 0;
+volatile uint32_t hdmi_vblank_count = 0;   // frames scanned out
 
-static void dma_handler_HDMI() {
-    hdmi_irq_count++;
-    static uint32_t inx_buf_dma;
-    static uint line = 0;
-    struct video_mode_t mode = graphics_get_video_mode(get_video_mode());
-    irq_inx++;
+// Interrupts and core cycles spent in them, over the last frame
+static uint32_t hdmi_frame_irqs;
+static uint32_t hdmi_frame_cycles;
+static uint32_t hdmi_last_irqs;
+static uint32_t hdmi_last_cycles;
 
-    dma_hw->ints0 = 1u << dma_chan_ctrl;
-    dma_channel_set_read_addr(dma_chan_ctrl, &DMA_BUF_ADDR[inx_buf_dma & 1], false);
+void graphics_get_irq_stats(uint32_t* irqs_per_frame, uint32_t* cycles_per_frame) {
+    *irqs_per_frame = hdmi_last_irqs;
+    *cycles_per_frame = hdmi_last_cycles;
+}
 
-    if (line >= mode.h_total ) {
-        line = 0;
-        vsync_handler();
-    } else {
-        ++line;
+// Fills the image part of an active line pair from graphics buffer row y
+static void __not_in_flash_func(hdmi_fill_row)(int y) {
+    uint8_t* activ_buf = HDMI_ROW_LINES(y);
+    uint8_t* output_buffer = activ_buf + HDMI_IMAGE_OFFSET;
+    //область изображения
+    uint8_t* input_buffer = get_line_buffer(y);
+    if (!input_buffer) {
+        // If no buffer, fill with black (255)
+        memset(output_buffer, 255, SCREEN_WIDTH);
     }
+    else switch (hdmi_graphics_mode) {
+        case GRAPHICSMODE_DEFAULT:
+            //заполняем пространство сверху и снизу графического буфера
+            if (false || (graphics_buffer_shift_y > y) || (y >= (graphics_buffer_shift_y + graphics_buffer_height))
+                || (graphics_buffer_shift_x >= SCREEN_WIDTH) || (
+                    (graphics_buffer_shift_x + graphics_buffer_width) < 0)) {
+                memset(output_buffer, 255, SCREEN_WIDTH);
+                break;
+            }
 
-    if ((line & 1) == 0) return;
-    inx_buf_dma++;
+        //рисуем пространство слева от буфера
+            for (int i = graphics_buffer_shift_x; i-- > 0;) {
+                *output_buffer++ = 255;
+            }
 
-    uint8_t* activ_buf = (uint8_t *)dma_lines[inx_buf_dma & 1];
+        //рисуем сам видеобуфер+пространство справа
+            // Optimized loop for 320 width
+            const uint8_t* end = output_buffer + SCREEN_WIDTH;
+            while (output_buffer < end) {
+                uint8_t c = *input_buffer++;
+                // Substitute HDMI reserved colors with nearest matches
+                if (c >= 240 && c <= 243) c = color_substitute[c - 240];
+                *output_buffer++ = c;
+            }
+            break;
+        default:
+            for (int i = SCREEN_WIDTH; i--;) {
+                uint8_t i_color = *input_buffer++;
+                // Substitute HDMI reserved colors with nearest matches
+                if (i_color >= 240 && i_color <= 243) i_color = color_substitute[i_color - 240];
+                *output_buffer++ = i_color;
+            }
+            break;
+    }
 
-    if (line < mode.h_width ) {
-        uint8_t* output_buffer = activ_buf + 72; //для выравнивания синхры;
-        int y = line >> 1;
-        //область изображения
-        uint8_t* input_buffer = get_line_buffer(y);
-        if (!input_buffer) {
-            // If no buffer, fill with black (255)
-            memset(output_buffer, 255, SCREEN_WIDTH);
-            return;
-        }
-        switch (hdmi_graphics_mode) {
-            case GRAPHICSMODE_DEFAULT:
-                //заполняем пространство сверху и снизу графического буфера
-                if (false || (graphics_buffer_shift_y > y) || (y >= (graphics_buffer_shift_y + graphics_buffer_height))
-                    || (graphics_buffer_shift_x >= SCREEN_WIDTH) || (
-                        (graphics_buffer_shift_x + graphics_buffer_width) < 0)) {
-                    memset(output_buffer, 255, SCREEN_WIDTH);
-                    break;
-                }
-
-                uint8_t* activ_buf_end = output_buffer + SCREEN_WIDTH;
-            //рисуем пространство слева от буфера
-                for (int i = graphics_buffer_shift_x; i-- > 0;) {
-                    *output_buffer++ = 255;
-                }
-
-            //рисуем сам видеобуфер+пространство справа
-///                input_buffer = &graphics_buffer[(y - graphics_buffer_shift_y) * graphics_buffer_width];
-                
-                // Optimized loop for 320 width
-                const uint8_t* end = output_buffer + SCREEN_WIDTH;
-                while (output_buffer < end) {
-                    uint8_t c = *input_buffer++;
-                    // Substitute HDMI reserved colors with nearest matches
-                    if (c >= 240 && c <= 243) c = color_substitute[c - 240];
-                    *output_buffer++ = c;
-                }
-                break;
-            default:
-                for (int i = SCREEN_WIDTH; i--;) {
-                    uint8_t i_color = *input_buffer++;
-                    // Substitute HDMI reserved colors with nearest matches
-                    if (i_color >= 240 && i_color <= 243) i_color = color_substitute[i_color - 240];
-                    *output_buffer++ = i_color;
-                }
-                break;
-        }
+    // Second line of the pair
+    memcpy(activ_buf + HDMI_LINE_BYTES + HDMI_IMAGE_OFFSET, activ_buf + HDMI_IMAGE_OFFSET, SCREEN_WIDTH);
+}
 
+// Converts the rows of the group starting at row y that are on screen
+static void __not_in_flash_func(hdmi_fill_group)(int y) {
+    for (int end = y + HDMI_ROWS_PER_IRQ; y < end && y < hdmi_active_blocks; y++) {
+        hdmi_fill_row(y);
+    }
+}
 
-        // memset(activ_buf,2,320);//test
+// Raised when dma_chan finishes a block that asks for it: the last of
+// each active group whose group after next is on screen, then once after
+// the last visible line and once near the end of the frame
+static bool hdmi_vblank_done;
+static bool hdmi_frame_done;
 
-        //ССИ
-        //для выравнивания синхры
+static void __not_in_flash_func(dma_handler_HDMI)() {
+    uint32_t start = m33_hw->dwt_cyccnt;
+    hdmi_irq_count++;
+    irq_inx++;
 
-        // --|_|---|_|---|_|----
-        //---|___________|-----
-        memset(activ_buf + 48,BASE_HDMI_CTRL_INX, 24);
-        memset(activ_buf,BASE_HDMI_CTRL_INX + 1, 48);
-        memset(activ_buf + 392,BASE_HDMI_CTRL_INX, 8);
+    dma_hw->ints0 = 1u << dma_chan;
 
-        //без выравнивания
-        // --|_|---|_|---|_|----
-        //------|___________|----
-        //   memset(activ_buf+320,BASE_HDMI_CTRL_INX,8);
-        //   memset(activ_buf+328,BASE_HDMI_CTRL_INX+1,48);
-        //   memset(activ_buf+376,BASE_HDMI_CTRL_INX,24);
+    // Block being sent now, found from how far the list has been read.
+    // The list rewinds itself, so a late interrupt only sees a later block
+    const hdmi_block_t* next = (const hdmi_block_t *)dma_hw->ch[dma_chan_ctrl].read_addr;
+    int block = (int)(next - hdmi_frame) - 1;
+
+    if (block < hdmi_active_blocks) {
+        hdmi_vblank_done = false;
+        hdmi_frame_done = false;
+        // The group after the one being sent, into the buffers just sent
+        hdmi_fill_group((block / HDMI_ROWS_PER_IRQ + 1) * HDMI_ROWS_PER_IRQ);
     }
     else {
-        if ((line >= 490) && (line < 492)) {
-            //кадровый синхроимпульс
-            //для выравнивания синхры
-            // --|_|---|_|---|_|----
-            //---|___________|-----
-            memset(activ_buf + 48,BASE_HDMI_CTRL_INX + 2, 352);
-            memset(activ_buf,BASE_HDMI_CTRL_INX + 3, 48);
-            //без выравнивания
-            // --|_|---|_|---|_|----
-            //-------|___________|----
-
-            // memset(activ_buf,BASE_HDMI_CTRL_INX+2,328);
-            // memset(activ_buf+328,BASE_HDMI_CTRL_INX+3,48);
-            // memset(activ_buf+376,BASE_HDMI_CTRL_INX+2,24);
+        // Once per frame, even if the interrupt for it was merged or late
+        if (!hdmi_vblank_done) {
+            hdmi_vblank_done = true;
+            hdmi_vblank_count++;    // last visible line done
         }
-        else {
-            //ССИ без изображения
-            //для выравнивания синхры
 
-            memset(activ_buf + 48,BASE_HDMI_CTRL_INX, 352);
+        if (block > HDMI_FRAME_IRQ && !hdmi_frame_done) {
+            hdmi_frame_done = true;
+            hdmi_fill_group(0);
+            hdmi_fill_group(HDMI_ROWS_PER_IRQ);
+            vsync_handler();
+
+            hdmi_last_irqs = hdmi_frame_irqs + 1;
+            hdmi_last_cycles = hdmi_frame_cycles + (m33_hw->dwt_cyccnt - start);
+            hdmi_frame_irqs = 0;
+            hdmi_frame_cycles = 0;
+            return;
+        }
+    }
+
+    hdmi_frame_irqs++;
+    hdmi_frame_cycles += m33_hw->dwt_cyccnt - start;
+}
+
+// Builds the line templates and the control block list for a frame;
+// cfg_line is dma_chan's setup for sending lines
+static void hdmi_build_frame(dma_channel_config cfg_line) {
+    struct video_mode_t mode = graphics_get_video_mode(get_video_mode());
+
+    //ССИ
+    //для выравнивания синхры
+
+    // --|_|---|_|---|_|----
+    //---|___________|-----
+    for (int i = 0; i < 2 * HDMI_LINE_BYTES; i += HDMI_LINE_BYTES) {
+        for (int y = 0; y < 2 * HDMI_ROWS_PER_IRQ; y++) {
+            uint8_t* activ_buf = HDMI_ROW_LINES(y) + i;
+            memset(activ_buf + 48,BASE_HDMI_CTRL_INX, 24);
             memset(activ_buf,BASE_HDMI_CTRL_INX + 1, 48);
+            memset(activ_buf + 392,BASE_HDMI_CTRL_INX, 8);
+        }
 
-            // memset(activ_buf,BASE_HDMI_CTRL_INX,328);
-            // memset(activ_buf+328,BASE_HDMI_CTRL_INX+1,48);
-            // memset(activ_buf+376,BASE_HDMI_CTRL_INX,24);
-        };
+        //ССИ без изображения
+        memset(hdmi_blank_lines + i + 48,BASE_HDMI_CTRL_INX, 352);
+        memset(hdmi_blank_lines + i,BASE_HDMI_CTRL_INX + 1, 48);
+
+        //кадровый синхроимпульс
+        memset(hdmi_vsync_lines + i + 48,BASE_HDMI_CTRL_INX + 2, 352);
+        memset(hdmi_vsync_lines + i,BASE_HDMI_CTRL_INX + 3, 48);
+    }
+    for (int y = 0; y < 2 * HDMI_ROWS_PER_IRQ; y++) {
+        memset(HDMI_ROW_LINES(y) + HDMI_IMAGE_OFFSET, 255, SCREEN_WIDTH);
+        memset(HDMI_ROW_LINES(y) + HDMI_LINE_BYTES + HDMI_IMAGE_OFFSET, 255, SCREEN_WIDTH);
     }
 
+    channel_config_set_irq_quiet(&cfg_line, true);
+    const uint32_t ctrl_quiet = channel_config_get_ctrl_value(&cfg_line);
+    channel_config_set_irq_quiet(&cfg_line, false);
+    const uint32_t ctrl_irq = channel_config_get_ctrl_value(&cfg_line);
+
+    // Lines 0..h_total; the last one has no pair
+    hdmi_active_blocks = mode.h_width / 2;
+    for (int n = 0; n < HDMI_FRAME_BLOCKS; n++) {
+        int line = n * 2;
+        hdmi_frame[n].write_addr = &PIO_VIDEO_ADDR->txf[SM_conv];
+        hdmi_frame[n].count = (line + 1 <= mode.h_total) ? 2 * HDMI_LINE_BYTES : HDMI_LINE_BYTES;
+        if (n < hdmi_active_blocks) {
+            hdmi_frame[n].read_addr = HDMI_ROW_LINES(n);
+        }
+        else if ((line >= 490) && (line < 492)) {
+            hdmi_frame[n].read_addr = hdmi_vsync_lines;
+        }
+        else {
+            hdmi_frame[n].read_addr = hdmi_blank_lines;
+        }
 
-    // y=(y==524)?0:(y+1);
-    // inx_buf_dma++;
+        // The interrupt comes as the next block starts
+        bool group_end = (n + 1) % HDMI_ROWS_PER_IRQ == 0
+                         && n + 1 + HDMI_ROWS_PER_IRQ < hdmi_active_blocks;
+        if (group_end || n == hdmi_active_blocks - 1 || n == HDMI_FRAME_IRQ) {
+            hdmi_frame[n].ctrl = ctrl_irq;
+        }
+        else {
+            hdmi_frame[n].ctrl = ctrl_quiet;
+        }
+    }
+
+    // Rewind: one word, the start of the list, written to dma_chan_ctrl's
+    // read address trigger. No chain, as that write restarts dma_chan_ctrl
+    dma_channel_config cfg_rewind = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&cfg_rewind, DMA_SIZE_32);
+    channel_config_set_read_increment(&cfg_rewind, false);
+    channel_config_set_write_increment(&cfg_rewind, false);
+    channel_config_set_irq_quiet(&cfg_rewind, true);
+    hdmi_frame[HDMI_FRAME_BLOCKS].read_addr = &hdmi_frame_start;
+    hdmi_frame[HDMI_FRAME_BLOCKS].write_addr = &dma_hw->ch[dma_chan_ctrl].al3_read_addr_trig;
+    hdmi_frame[HDMI_FRAME_BLOCKS].count = 1;
+    hdmi_frame[HDMI_FRAME_BLOCKS].ctrl = channel_config_get_ctrl_value(&cfg_rewind);
 }
 
 
@@ -368,14 +470,18 @@ void graphics_set_palette_hdmi(const uint8_t i, const uint32_t color888);
 static inline bool hdmi_init() {
     //выключение прерывания DMA
     if (VIDEO_DMA_IRQ == DMA_IRQ_0) {
-        dma_channel_set_irq0_enabled(dma_chan_ctrl, false);
+        dma_channel_set_irq0_enabled(dma_chan, false);
     }
     else {
-        dma_channel_set_irq1_enabled(dma_chan_ctrl, false);
+        dma_channel_set_irq1_enabled(dma_chan, false);
     }
 
     irq_remove_handler_DMA_core1();
 
+    // Cycle counter for the interrupt time statistics
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+
 
     //остановка всех каналов DMA
     dma_hw->abort = (1 << dma_chan_ctrl) | (1 << dma_chan) | (1 << dma_chan_pal_conv) | (
@@ -490,9 +596,6 @@ static inline bool hdmi_init() {
     pio_sm_set_enabled(PIO_VIDEO, SM_video, true);
 
     //настройки DMA
-    dma_lines[0] = &conv_color[1024];
-    dma_lines[1] = &conv_color[1124];
-
     //основной рабочий канал
     dma_channel_config cfg_dma = dma_channel_get_default_config(dma_chan);
     channel_config_set_transfer_data_size(&cfg_dma, DMA_SIZE_8);
@@ -507,32 +610,32 @@ static inline bool hdmi_init() {
 
     channel_config_set_dreq(&cfg_dma, dreq);
 
+    hdmi_build_frame(cfg_dma);
+
     dma_channel_configure(
         dma_chan,
         &cfg_dma,
         &PIO_VIDEO_ADDR->txf[SM_conv], // Write address
-        &dma_lines[0][0], // read address
-        400, //
+        hdmi_frame[0].read_addr, // read address
+        hdmi_frame[0].count, //
         false // Don't start yet
     );
 
-    //контрольный канал для основного
+    //контрольный канал для основного: пишет блок (read_addr, write_addr,
+    //count, ctrl) в регистры основного канала, запись ctrl_trig его запускает
     cfg_dma = dma_channel_get_default_config(dma_chan_ctrl);
     channel_config_set_transfer_data_size(&cfg_dma, DMA_SIZE_32);
-    channel_config_set_chain_to(&cfg_dma, dma_chan); // chain to other channel
 
-    channel_config_set_read_increment(&cfg_dma, false);
-    channel_config_set_write_increment(&cfg_dma, false);
-
-    DMA_BUF_ADDR[0] = &dma_lines[0][0];
-    DMA_BUF_ADDR[1] = &dma_lines[1][0];
+    channel_config_set_read_increment(&cfg_dma, true);
+    channel_config_set_write_increment(&cfg_dma, true);
+    channel_config_set_ring(&cfg_dma, true, 4); // wrap writes to the four registers
 
     dma_channel_configure(
         dma_chan_ctrl,
         &cfg_dma,
         &dma_hw->ch[dma_chan].read_addr, // Write address
-        &DMA_BUF_ADDR[0], // read address
-        1, //
+        &hdmi_frame[0], // read address
+        4, //
         false // Don't start yet
     );
 
@@ -584,12 +687,12 @@ static inline bool hdmi_init() {
 
     //стартуем прерывание и канал
     if (VIDEO_DMA_IRQ == DMA_IRQ_0) {
-        dma_channel_acknowledge_irq0(dma_chan_ctrl);
-        dma_channel_set_irq0_enabled(dma_chan_ctrl, true);
+        dma_channel_acknowledge_irq0(dma_chan);
+        dma_channel_set_irq0_enabled(dma_chan, true);
     }
     else {
-        dma_channel_acknowledge_irq1(dma_chan_ctrl);
-        dma_channel_set_irq1_enabled(dma_chan_ctrl, true);
+        dma_channel_acknowledge_irq1(dma_chan);
+        dma_channel_set_irq1_enabled(dma_chan, true);
     }
 
     irq_set_exclusive_handler_DMA_core1();
@@ -60,6 +60,7 @@ void graphics_set_res(int w, int h);
 void graphics_set_shift(int x, int y);
 void graphics_set_palette(uint8_t i, uint32_t color888);
 void graphics_restore_sync_colors(void);
+void graphics_get_irq_stats(uint32_t* irqs_per_frame, uint32_t* cycles_per_frame);
 void startVIDEO(uint8_t vol);
 void set_palette(uint8_t n); // переключение палитр
 
@@ -0,0 +1,78 @@
+// Input Event Ring
+// Fixed-size lock-free single-producer/single-consumer event queue.
+// The producer is a device IRQ handler (or the TinyUSB host task), the
+// consumer is the game loop; the two may run on different cores.
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef INPUT_RING_H
+#define INPUT_RING_H
+
+#include <stdint.h>
+#include "pico.h"
+#include "hardware/sync.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Must be a power of two
+#define INPUT_RING_SIZE 64
+
+// Event types
+#define INPUT_EVENT_KEYUP   0
+#define INPUT_EVENT_KEYDOWN 1
+#define INPUT_EVENT_MOTION  2
+
+typedef struct {
+    uint32_t time_us;   // Capture time (time_us_32)
+    uint8_t  type;      // INPUT_EVENT_*
+    uint8_t  code;      // Key code, or button state for motion
+    int8_t   wheel;     // Wheel movement
+    int16_t  dx;        // X movement
+    int16_t  dy;        // Y movement
+} input_event_t;
+
+typedef struct {
+    volatile uint32_t head;     // Written by the producer only
+    volatile uint32_t tail;     // Written by the consumer only
+    volatile uint32_t dropped;  // Events lost to a full ring
+    input_event_t events[INPUT_RING_SIZE];
+} input_ring_t;
+
+static inline void input_ring_init(input_ring_t *ring) {
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+}
+
+// Producer side. Returns 0 (and counts a drop) if the ring is full.
+static __force_inline int input_ring_push(input_ring_t *ring, const input_event_t *ev) {
+    uint32_t head = ring->head;
+    if (head - ring->tail >= INPUT_RING_SIZE) {
+        ring->dropped++;
+        return 0;
+    }
+    ring->events[head & (INPUT_RING_SIZE - 1)] = *ev;
+    __dmb();            // Publish the event before the new head
+    ring->head = head + 1;
+    return 1;
+}
+
+// Consumer side. Returns 0 if the ring is empty.
+static __force_inline int input_ring_pop(input_ring_t *ring, input_event_t *ev) {
+    uint32_t tail = ring->tail;
+    if (tail == ring->head) {
+        return 0;
+    }
+    __dmb();            // Read the event only after seeing its head
+    *ev = ring->events[tail & (INPUT_RING_SIZE - 1)];
+    __dmb();            // Finish reading before handing the slot back
+    ring->tail = tail + 1;
+    return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INPUT_RING_H
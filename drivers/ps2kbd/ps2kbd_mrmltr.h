@@ -63,6 +63,9 @@ public:
   void init_gpio();
   
   void __not_in_flash_func(tick)();
+
+  PIO pio() const { return _pio; }
+  uint sm() const { return _sm; }
 };
 
 #endif
\ No newline at end of file
@@ -2,17 +2,23 @@
 #include "ps2kbd_wrapper.h"
 #include "ps2kbd_mrmltr.h"
 #include "doomkeys.h"
-#include <queue>
+#include "input_ring.h"
+#include "hardware/irq.h"
+#include "pico/time.h"
 
-struct KeyEvent {
-    int pressed;
-    unsigned char key;
-};
+// Key events queued by the PIO IRQ, drained by ps2kbd_get_key()
+static input_ring_t key_ring;
 
-static std::queue<KeyEvent> event_queue;
+static void __not_in_flash_func(push_key)(int pressed, unsigned char key) {
+    input_event_t ev = {};
+    ev.time_us = time_us_32();
+    ev.type = pressed ? INPUT_EVENT_KEYDOWN : INPUT_EVENT_KEYUP;
+    ev.code = key;
+    input_ring_push(&key_ring, &ev);
+}
 
 // HID to Doom mapping (partial)
-static unsigned char hid_to_doom(uint8_t code) {
+static unsigned char __not_in_flash_func(hid_to_doom)(uint8_t code) {
     if (code >= 0x04 && code <= 0x1D) return 'a' + (code - 0x04);
     if (code >= 0x1E && code <= 0x27) {
         if (code == 0x27) return '0';
@@ -39,24 +45,24 @@ static unsigned char hid_to_doom(uint8_t code) {
     return 0;
 }
 
-static void key_handler(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev) {
+static void __not_in_flash_func(key_handler)(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev) {
     // Check modifiers - Map Ctrl to FIRE, Alt to ALT (for strafe)
     uint8_t changed_mods = curr->modifier ^ prev->modifier;
     if (changed_mods) {
         // Map Ctrl (left or right) to KEY_FIRE for shooting
         if (changed_mods & (KEYBOARD_MODIFIER_LEFTCTRL | KEYBOARD_MODIFIER_RIGHTCTRL)) {
             int ctrl_pressed = (curr->modifier & (KEYBOARD_MODIFIER_LEFTCTRL | KEYBOARD_MODIFIER_RIGHTCTRL)) != 0;
-            event_queue.push({ctrl_pressed, KEY_FIRE});  // Changed from KEY_RCTRL to KEY_FIRE
+            push_key(ctrl_pressed, KEY_FIRE);  // Changed from KEY_RCTRL to KEY_FIRE
         }
         // Map Shift to Shift (for running)
         if (changed_mods & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT)) {
             int shift_pressed = (curr->modifier & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT)) != 0;
-            event_queue.push({shift_pressed, KEY_RSHIFT});
+            push_key(shift_pressed, KEY_RSHIFT);
         }
         // Map Alt to Alt (for strafing)
         if (changed_mods & (KEYBOARD_MODIFIER_LEFTALT | KEYBOARD_MODIFIER_RIGHTALT)) {
             int alt_pressed = (curr->modifier & (KEYBOARD_MODIFIER_LEFTALT | KEYBOARD_MODIFIER_RIGHTALT)) != 0;
-            event_queue.push({alt_pressed, KEY_RALT});
+            push_key(alt_pressed, KEY_RALT);
         }
     }
 
@@ -72,7 +78,7 @@ static void key_handler(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev
             }
             if (!found) {
                 unsigned char k = hid_to_doom(curr->keycode[i]);
-                if (k) event_queue.push({1, k});
+                if (k) push_key(1, k);
             }
         }
     }
@@ -88,7 +94,7 @@ static void key_handler(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev
             }
             if (!found) {
                 unsigned char k = hid_to_doom(prev->keycode[i]);
-                if (k) event_queue.push({0, k});
+                if (k) push_key(0, k);
             }
         }
     }
@@ -96,23 +102,34 @@ static void key_handler(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev
 
 static Ps2Kbd_Mrmltr* kbd = nullptr;
 
+// Scan codes are decoded as soon as the PIO receives them
+static void __not_in_flash_func(ps2kbd_irq_handler)(void) {
+    kbd->tick();
+}
+
 extern "C" void ps2kbd_init(void) {
+    input_ring_init(&key_ring);
+
     // PS2 keyboard driver expects base_gpio as CLK, and base_gpio+1 as DATA
     // For M1: PS2_PIN_CLK=0, PS2_PIN_DATA=1, so base should be PS2_PIN_CLK
     // For M2: PS2_PIN_CLK=2, PS2_PIN_DATA=3, so base should be PS2_PIN_CLK
     kbd = new Ps2Kbd_Mrmltr(pio0, PS2_PIN_CLK, key_handler);
     kbd->init_gpio();
+
+    // Interrupt on RX FIFO not empty; shared in case PIO0 IRQ 0 is also used elsewhere
+    pio_set_irq0_source_enabled(kbd->pio(), pio_get_rx_fifo_not_empty_interrupt_source(kbd->sm()), true);
+    irq_add_shared_handler(PIO0_IRQ_0, ps2kbd_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(PIO0_IRQ_0, true);
 }
 
 extern "C" void ps2kbd_tick(void) {
-    if (kbd) kbd->tick();
+    // Serviced from the PIO IRQ; nothing to poll
 }
 
 extern "C" int ps2kbd_get_key(int* pressed, unsigned char* key) {
-    if (event_queue.empty()) return 0;
-    KeyEvent e = event_queue.front();
-    event_queue.pop();
-    *pressed = e.pressed;
-    *key = e.key;
+    input_event_t e;
+    if (!input_ring_pop(&key_ring, &e)) return 0;
+    *pressed = e.type == INPUT_EVENT_KEYDOWN;
+    *key = e.code;
     return 1;
 }
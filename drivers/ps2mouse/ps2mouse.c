@@ -4,6 +4,7 @@
 
 #include "ps2mouse.h"
 #include "board_config.h"
+#include "input_ring.h"
 #include <pico/stdlib.h>
 #include <hardware/gpio.h>
 #include <hardware/irq.h>
@@ -49,10 +50,15 @@ static volatile uint8_t mouse_buffer[MOUSE_BUFFER_SIZE];
 static volatile uint8_t mouse_buffer_head = 0;
 static volatile uint8_t mouse_buffer_tail = 0;
 
-// Mouse state
+// Mouse state (owned by the consumer, fed from mouse_ring)
 static ps2mouse_state_t mouse_state = {0};
 static volatile int mouse_irq_enabled = 0;
 
+// Decoded packets, filled by the clock IRQ once the mouse is streaming.
+// Until then (reset/identify), raw bytes go through mouse_buffer instead.
+static input_ring_t mouse_ring;
+static volatile int mouse_streaming = 0;
+
 // Packet parsing state
 static uint8_t packet_data[4];
 static uint8_t packet_index = 0;
@@ -219,6 +225,8 @@ done:
     busy_wait_ms(25);  // Give device time to respond
 }
 
+static void mouse_packet_byte(uint8_t byte);
+
 //-----------------------------------------------------------------------------
 // GPIO IRQ handler for mouse clock
 //-----------------------------------------------------------------------------
@@ -249,11 +257,16 @@ static void __not_in_flash_func(mouse_gpio_callback)(uint gpio, uint32_t events)
     
     // Complete byte received (11 bits: start + 8 data + parity + stop)
     if (mouse_bitcount == 11) {
-        // Add to circular buffer
-        uint8_t next_head = (mouse_buffer_head + 1) % MOUSE_BUFFER_SIZE;
-        if (next_head != mouse_buffer_tail) {
-            mouse_buffer[mouse_buffer_head] = mouse_incoming;
-            mouse_buffer_head = next_head;
+        if (mouse_streaming) {
+            // Decode packets here so motion is timestamped on arrival
+            mouse_packet_byte(mouse_incoming);
+        } else {
+            // Add to circular buffer
+            uint8_t next_head = (mouse_buffer_head + 1) % MOUSE_BUFFER_SIZE;
+            if (next_head != mouse_buffer_tail) {
+                mouse_buffer[mouse_buffer_head] = mouse_incoming;
+                mouse_buffer_head = next_head;
+            }
         }
         mouse_bitcount = 0;
         mouse_incoming = 0;
@@ -277,7 +290,7 @@ static int mouse_buffer_get(uint8_t *byte) {
 // Process a complete mouse packet
 //-----------------------------------------------------------------------------
 
-static void process_mouse_packet(void) {
+static void __not_in_flash_func(process_mouse_packet)(void) {
     uint8_t status = packet_data[0];
     
     // PS/2 mouse status byte bit 3 should always be 1 (sync bit)
@@ -312,11 +325,39 @@ static void process_mouse_packet(void) {
         if (wheel < -8) wheel = -8;
     }
     
-    // Accumulate movement
-    mouse_state.delta_x += dx;
-    mouse_state.delta_y += dy;
-    mouse_state.wheel += wheel;
-    mouse_state.buttons = buttons;
+    input_event_t ev;
+    ev.time_us = time_us_32();
+    ev.type = INPUT_EVENT_MOTION;
+    ev.code = buttons;
+    ev.dx = dx;
+    ev.dy = dy;
+    ev.wheel = wheel;
+    input_ring_push(&mouse_ring, &ev);
+}
+
+//-----------------------------------------------------------------------------
+// Assemble packets from received bytes (called from the clock IRQ)
+//-----------------------------------------------------------------------------
+
+static void __not_in_flash_func(mouse_packet_byte)(uint8_t byte) {
+    // Skip ACK bytes
+    if (byte == MOUSE_RESP_ACK) return;
+    
+    // If this is the first byte of a packet, validate it
+    // The status byte (first byte) must have bit 3 set (always 1 sync bit)
+    if (packet_index == 0 && !(byte & 0x08)) {
+        // Invalid first byte - skip it and try to resync
+        return;
+    }
+    
+    // Add byte to packet
+    packet_data[packet_index++] = byte;
+    
+    // Check for complete packet
+    if (packet_index >= packet_size) {
+        process_mouse_packet();
+        packet_index = 0;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -325,6 +366,8 @@ static void process_mouse_packet(void) {
 
 void ps2mouse_init(void) {
     memset((void*)&mouse_state, 0, sizeof(mouse_state));
+    mouse_streaming = 0;
+    input_ring_init(&mouse_ring);
     mouse_buffer_head = 0;
     mouse_buffer_tail = 0;
     mouse_bitcount = 0;
@@ -399,6 +442,10 @@ void ps2mouse_init(void) {
     // Clear any pending bytes
     while (mouse_buffer_get(&dummy)) {}
     
+    // From now on the IRQ decodes packets straight into mouse_ring
+    packet_index = 0;
+    mouse_streaming = 1;
+    
     mouse_state.initialized = 1;
     
     printf("PS/2 Mouse initialized%s\n", 
@@ -410,29 +457,14 @@ void ps2mouse_init(void) {
 //-----------------------------------------------------------------------------
 
 void ps2mouse_poll(void) {
-    uint8_t byte;
-    
-    while (mouse_buffer_get(&byte)) {
-        // Skip ACK bytes
-        if (byte == MOUSE_RESP_ACK) continue;
-        
-        // If this is the first byte of a packet, validate it
-        // The status byte (first byte) must have bit 3 set (always 1 sync bit)
-        if (packet_index == 0) {
-            if (!(byte & 0x08)) {
-                // Invalid first byte - skip it and try to resync
-                continue;
-            }
-        }
-        
-        // Add byte to packet
-        packet_data[packet_index++] = byte;
-        
-        // Check for complete packet
-        if (packet_index >= packet_size) {
-            process_mouse_packet();
-            packet_index = 0;
-        }
+    input_event_t ev;
+    
+    // Accumulate decoded packets queued by the clock IRQ
+    while (input_ring_pop(&mouse_ring, &ev)) {
+        mouse_state.delta_x += ev.dx;
+        mouse_state.delta_y += ev.dy;
+        mouse_state.wheel += ev.wheel;
+        mouse_state.buttons = ev.code;
     }
 }
 
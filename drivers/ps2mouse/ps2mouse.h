@@ -24,7 +24,7 @@ typedef struct {
 // Initialize the PS/2 mouse driver
 void ps2mouse_init(void);
 
-// Poll for mouse data (call regularly from main loop)
+// Collect packets decoded by the clock IRQ into the accumulators
 void ps2mouse_poll(void);
 
 // Get accumulated mouse movement and clear accumulators
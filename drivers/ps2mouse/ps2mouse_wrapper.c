@@ -21,8 +21,15 @@ extern void D_PostEvent(event_t *ev);
 // Track previous button state to detect changes
 static uint8_t prev_buttons = 0;
 
+// Motion pulled out early by ps2mouse_wrapper_latch(), posted by the next tick,
+// and the last button change it saw (-1 = none)
+static int latched_dx = 0;
+static int latched_dy = 0;
+static int latched_wheel = 0;
+static int latched_buttons = -1;
+
 // Clamp value to range
-static inline int16_t clamp_delta(int16_t val, int16_t max_val) {
+static inline int16_t clamp_delta(int val, int16_t max_val) {
     if (val > max_val) return max_val;
     if (val < -max_val) return -max_val;
     return val;
@@ -31,6 +38,26 @@ static inline int16_t clamp_delta(int16_t val, int16_t max_val) {
 void ps2mouse_wrapper_init(void) {
     ps2mouse_init();
     prev_buttons = 0;
+    latched_dx = latched_dy = latched_wheel = 0;
+    latched_buttons = -1;
+}
+
+int ps2mouse_wrapper_latch(void) {
+    int16_t dx, dy;
+    int8_t wheel;
+    uint8_t buttons;
+
+    if (ps2mouse_get_state(&dx, &dy, &wheel, &buttons)) {
+        latched_dx += dx;
+        latched_dy += dy;
+        latched_wheel += wheel;
+    }
+    if ((buttons & 0x07) != prev_buttons) {
+        latched_buttons = buttons & 0x07;
+    }
+
+    // Same scaling the next tick will apply to data2
+    return clamp_delta(latched_dx, MOUSE_MAX_DELTA) * MOUSE_SENSITIVITY_MULT;
 }
 
 void ps2mouse_wrapper_tick(void) {
@@ -38,8 +65,27 @@ void ps2mouse_wrapper_tick(void) {
     int8_t wheel;
     uint8_t buttons;
     
-    // Get accumulated mouse movement
+    // Get accumulated mouse movement, plus anything latched since the last tick
     int has_motion = ps2mouse_get_state(&dx, &dy, &wheel, &buttons);
+    if (latched_dx || latched_dy || latched_wheel) {
+        dx = clamp_delta(dx + latched_dx, INT16_MAX);
+        dy = clamp_delta(dy + latched_dy, INT16_MAX);
+        wheel = clamp_delta(wheel + latched_wheel, INT8_MAX);
+        latched_dx = latched_dy = latched_wheel = 0;
+        has_motion = 1;
+    }
+
+    // A button change only the latch saw, already undone, still gets posted
+    if (latched_buttons >= 0 && latched_buttons != prev_buttons
+        && latched_buttons != (buttons & 0x07)) {
+        event_t ev;
+        ev.type = ev_mouse;
+        ev.data1 = latched_buttons;
+        ev.data2 = ev.data3 = ev.data4 = 0;
+        D_PostEvent(&ev);
+        prev_buttons = latched_buttons;
+    }
+    latched_buttons = -1;
     
     // Only post event if there's actual motion or button change
     // DOOM expects: data1 = buttons, data2 = X motion (turn), data3 = Y motion (forward)
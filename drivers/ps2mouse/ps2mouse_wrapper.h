@@ -16,6 +16,11 @@ void ps2mouse_wrapper_init(void);
 // Call this from the main game loop
 void ps2mouse_wrapper_tick(void);
 
+// Poll mouse ahead of the next tick without posting an event
+// Returns the pending turn in ev_mouse data2 units; the motion is
+// kept and posted by the next ps2mouse_wrapper_tick()
+int ps2mouse_wrapper_latch(void);
+
 #ifdef __cplusplus
 }
 #endif
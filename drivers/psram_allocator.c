@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include "pico/stdlib.h"
 #include "hardware/sync.h"
 
@@ -126,6 +127,22 @@ void *psram_malloc(size_t size) {
     }
 }
 
+// Left free by sram_try_malloc for the heap's own rounding and for the
+// small allocations made later, which have no fallback
+#define SRAM_HEAP_RESERVE (16 * 1024)
+
+void *sram_try_malloc(size_t size) {
+    extern char __StackLimit;   // where the SDK's sbrk stops the heap
+    char *top = sbrk(0);
+
+    // Only the space above the heap is counted: freed blocks below it
+    // may be too fragmented to hold the request
+    if (top == (char *)-1 || (size_t)(&__StackLimit - top) < size + SRAM_HEAP_RESERVE) {
+        return NULL;
+    }
+    return malloc(size);
+}
+
 void *psram_realloc(void *ptr, size_t new_size) {
     if (ptr == NULL) return psram_malloc(new_size);
     if (new_size == 0) { psram_free(ptr); return NULL; }
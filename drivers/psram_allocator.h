@@ -20,4 +20,8 @@ void psram_set_temp_offset(size_t offset);
 
 void psram_set_sram_mode(int enable); // Force SRAM allocation for proper malloc/free
 
+// Allocates from the SRAM heap if it still has room, else returns NULL
+// (plain malloc panics when it runs out)
+void *sram_try_malloc(size_t size);
+
 #endif
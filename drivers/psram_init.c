@@ -3,6 +3,7 @@
 #include "hardware/structs/xip_ctrl.h"
 #include "hardware/clocks.h"
 #include "hardware/gpio.h"
+#include "hardware/sync.h"
 #include "pico/stdlib.h"
 
 // PSRAM max frequency from build config (default 133 MHz)
@@ -10,6 +11,39 @@
 #define PSRAM_MAX_FREQ_MHZ 133
 #endif
 
+static size_t psram_size;
+
+uint32_t __no_inline_not_in_flash_func(psram_make_timing)(int clock_hz, int divisor, int rxdelay, int cooldown) {
+    const int clock_period_fs = 1000000000000000ll / clock_hz;
+    
+    const int max_select_val = (125 * 1000000) / clock_period_fs;
+
+    const int min_deselect = (18 * 1000000 + (clock_period_fs - 1)) / clock_period_fs - (divisor + 1) / 2;
+
+    return
+        cooldown << QMI_M1_TIMING_COOLDOWN_LSB | 
+        QMI_M1_TIMING_PAGEBREAK_VALUE_1024 << QMI_M1_TIMING_PAGEBREAK_LSB | 
+        max_select_val << QMI_M1_TIMING_MAX_SELECT_LSB | 
+        min_deselect << QMI_M1_TIMING_MIN_DESELECT_LSB | 
+        rxdelay << QMI_M1_TIMING_RXDELAY_LSB | 
+        divisor << QMI_M1_TIMING_CLKDIV_LSB;
+}
+
+// Writes at each power of two offset until one lands on the first word,
+// which happens once the offset reaches the size of the chip. Overwrites
+// what is there, so only before anything is kept in PSRAM.
+static size_t __no_inline_not_in_flash_func(psram_detect_size)(void) {
+    volatile uint32_t *psram = (volatile uint32_t *)(XIP_NOCACHE_NOALLOC_BASE + 0x01000000);
+    size_t size;
+
+    psram[0] = 0;
+    for (size = 1024 * 1024; size < 16 * 1024 * 1024; size <<= 1) {
+        psram[size / 4] = size;
+        if (psram[0] != 0) break;
+    }
+    return size;
+}
+
 void __no_inline_not_in_flash_func(psram_init)(uint cs_pin) {
     const int clock_hz = clock_get_hz(clk_sys); 
 
@@ -37,19 +71,7 @@ void __no_inline_not_in_flash_func(psram_init)(uint cs_pin) {
         rxdelay += 1; 
     }
 
-    const int clock_period_fs = 1000000000000000ll / clock_hz;
-    
-    const int max_select_val = (125 * 1000000) / clock_period_fs;
-
-    const int min_deselect = (18 * 1000000 + (clock_period_fs - 1)) / clock_period_fs - (divisor + 1) / 2;
-
-    qmi_hw->m[1].timing = 
-        1 << QMI_M1_TIMING_COOLDOWN_LSB | 
-        QMI_M1_TIMING_PAGEBREAK_VALUE_1024 << QMI_M1_TIMING_PAGEBREAK_LSB | 
-        max_select_val << QMI_M1_TIMING_MAX_SELECT_LSB | 
-        min_deselect << QMI_M1_TIMING_MIN_DESELECT_LSB | 
-        rxdelay << QMI_M1_TIMING_RXDELAY_LSB | 
-        divisor << QMI_M1_TIMING_CLKDIV_LSB;
+    qmi_hw->m[1].timing = psram_make_timing(clock_hz, divisor, rxdelay, 1);
 
     qmi_hw->m[1].rfmt =
         QMI_M0_RFMT_PREFIX_WIDTH_VALUE_Q << QMI_M0_RFMT_PREFIX_WIDTH_LSB | 
@@ -75,4 +97,45 @@ void __no_inline_not_in_flash_func(psram_init)(uint cs_pin) {
     qmi_hw->direct_csr = 0;
     
     hw_set_bits(&xip_ctrl_hw->ctrl, XIP_CTRL_WRITABLE_M1_BITS);
+
+    psram_size = psram_detect_size();
+}
+
+size_t psram_get_size(void) {
+    return psram_size;
+}
+
+// Puts the chip back in QPI mode after a test at a bad timing, which may
+// have garbled a command: exit QPI, reset, then enter QPI again. Direct
+// mode stops all XIP access to the chip, so interrupts are kept off.
+void __no_inline_not_in_flash_func(psram_reset_chip)(void) {
+    uint32_t save = save_and_disable_interrupts();
+
+    qmi_hw->direct_csr = 10 << QMI_DIRECT_CSR_CLKDIV_LSB | 
+                        QMI_DIRECT_CSR_EN_BITS | 
+                        QMI_DIRECT_CSR_AUTO_CS1N_BITS;
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
+
+    const uint CMD_QPI_EXIT = 0xF5;
+    qmi_hw->direct_tx = QMI_DIRECT_TX_NOPUSH_BITS | QMI_DIRECT_TX_OE_BITS |
+                        QMI_DIRECT_TX_IWIDTH_VALUE_Q << QMI_DIRECT_TX_IWIDTH_LSB |
+                        CMD_QPI_EXIT;
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
+
+    const uint CMD_RESET_EN = 0x66;
+    qmi_hw->direct_tx = QMI_DIRECT_TX_NOPUSH_BITS | CMD_RESET_EN;
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
+
+    const uint CMD_RESET = 0x99;
+    qmi_hw->direct_tx = QMI_DIRECT_TX_NOPUSH_BITS | CMD_RESET;
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
+    busy_wait_at_least_cycles(100);    // reset time
+
+    const uint CMD_QPI_EN = 0x35;
+    qmi_hw->direct_tx = QMI_DIRECT_TX_NOPUSH_BITS | CMD_QPI_EN;
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
+
+    qmi_hw->direct_csr = 0;
+
+    restore_interrupts(save);
 }
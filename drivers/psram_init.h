@@ -5,4 +5,14 @@
 
 void psram_init(uint cs_pin);
 
+// Size of the chip in bytes, as found by psram_init
+size_t psram_get_size(void);
+
+// QMI M1 timing register value for a clock divisor, read delay (in half
+// system clocks) and chip select cooldown (in 64 system clocks)
+uint32_t psram_make_timing(int clock_hz, int divisor, int rxdelay, int cooldown);
+
+// Resets the chip and enters QPI mode again, keeping the QMI setup
+void psram_reset_chip(void);
+
 #endif
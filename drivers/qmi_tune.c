@@ -0,0 +1,277 @@
+// QMI Timing Calibration
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "qmi_tune.h"
+#include "psram_init.h"
+#include "hardware/structs/qmi.h"
+#include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+
+// Fastest QMI clocks tried. The PSRAM is held to its rated clock, so
+// calibration only picks the read delay and cooldown for it.
+#ifndef PSRAM_MAX_FREQ_MHZ
+#define PSRAM_MAX_FREQ_MHZ 133
+#endif
+#ifndef QMI_TUNE_PSRAM_MAX_MHZ
+#define QMI_TUNE_PSRAM_MAX_MHZ PSRAM_MAX_FREQ_MHZ
+#endif
+#ifndef QMI_TUNE_FLASH_MAX_MHZ
+#define QMI_TUNE_FLASH_MAX_MHZ 133
+#endif
+
+#define TUNE_PASSES     3   // runs of the test a setting must pass
+#define TUNE_WINDOW     3   // passing read delays needed around the one used
+#define MAX_RXDELAY     (QMI_M1_TIMING_RXDELAY_BITS >> QMI_M1_TIMING_RXDELAY_LSB)
+#define MAX_COOLDOWN    (QMI_M1_TIMING_COOLDOWN_BITS >> QMI_M1_TIMING_COOLDOWN_LSB)
+
+#define PSRAM_CACHED    ((volatile uint32_t *)0x11000000)
+#define PSRAM_UNCACHED  ((volatile uint32_t *)(XIP_NOCACHE_NOALLOC_BASE + 0x01000000))
+
+// Word offsets of the test areas
+#define BURST_WORDS     (32 * 1024 / 4)     // twice the XIP cache
+#define BURST_AREA      (64 * 1024 / 4)
+#define EVICT_AREA      (128 * 1024 / 4)
+#define BANDWIDTH_AREA  (1024 * 1024 / 4)
+#define BANDWIDTH_WORDS (256 * 1024 / 4)
+
+#define FLASH_UNCACHED  ((const volatile uint32_t *)XIP_NOCACHE_NOALLOC_BASE)
+#define FLASH_TEST_WORDS (64 * 1024 / 4)
+#define FLASH_CMD_READ_STATUS 0x05
+
+static uint32_t psram_seed = 0x12345678;
+
+static bool __no_inline_not_in_flash_func(psram_test)(uint32_t size) {
+    volatile uint32_t *un = PSRAM_UNCACHED;
+    volatile uint32_t *ca = PSRAM_CACHED;
+    uint32_t seed = psram_seed;
+    uint32_t sink = 0;
+    bool ok = true;
+
+    // New data each time, so stale cache lines can't pass for good reads
+    psram_seed = psram_seed * 1664525 + 1013904223;
+
+    // Walking ones and zeros on the data lines
+    for (int i = 0; i < 32; i++) {
+        un[i * 2] = 1u << i;
+        un[i * 2 + 1] = ~(1u << i);
+    }
+    for (int i = 0; i < 32; i++) {
+        if (un[i * 2] != 1u << i || un[i * 2 + 1] != ~(1u << i)) ok = false;
+    }
+
+    // Address in address, on each address line and on every 4 KB page
+    for (uint32_t a = 256; a < 4096; a <<= 1) un[a / 4] = a ^ seed;
+    for (uint32_t a = 4096; a < size; a += 4096) un[a / 4] = a ^ seed;
+    for (uint32_t a = 256; a < 4096; a <<= 1) {
+        if (un[a / 4] != (a ^ seed)) ok = false;
+    }
+    for (uint32_t a = 4096; a < size; a += 4096) {
+        if (un[a / 4] != (a ^ seed)) ok = false;
+    }
+
+    // Bursts: cache line fills in sequence run as one longer transfer
+    // while the chip select is held through the cooldown. Reading
+    // another area twice the cache size first pushes out earlier lines.
+    for (int i = 0; i < BURST_WORDS; i++) un[BURST_AREA + i] = (i * 0x9e3779b9u) ^ seed;
+    for (int i = 0; i < BURST_WORDS; i++) sink += ca[EVICT_AREA + i];
+    for (int i = 0; i < BURST_WORDS; i++) {
+        if (ca[BURST_AREA + i] != ((i * 0x9e3779b9u) ^ seed)) ok = false;
+    }
+
+    (void)sink;
+    return ok;
+}
+
+// Runs from SRAM with interrupts off, so no handler touches PSRAM while
+// it is at a timing that may not work. A timing that fails is taken back
+// out before interrupts are on again.
+static bool __no_inline_not_in_flash_func(psram_try)(uint32_t timing) {
+    const uint32_t size = psram_get_size();
+    uint32_t save = save_and_disable_interrupts();
+    uint32_t old = qmi_hw->m[1].timing;
+    bool ok = true;
+
+    qmi_hw->m[1].timing = timing;
+    for (int pass = 0; pass < TUNE_PASSES && ok; pass++) {
+        if (!psram_test(size)) {
+            qmi_hw->m[1].timing = old;
+            psram_reset_chip();
+            ok = false;
+        }
+    }
+
+    restore_interrupts(save);
+    return ok;
+}
+
+// Reads the start of flash with the given M0 timing, then goes back to
+// the old one. Runs from SRAM with interrupts off, as nothing may be
+// fetched from flash in between. A bad read may also have knocked the
+// chip out of continuous read mode, so on a mismatch a status register
+// read, the shortest command cycle, sets XIP up again before returning
+// to code in flash.
+static uint32_t __no_inline_not_in_flash_func(flash_checksum)(uint32_t timing, uint32_t expect) {
+    uint32_t save = save_and_disable_interrupts();
+    uint32_t old = qmi_hw->m[0].timing;
+    uint32_t sum = 0;
+
+    qmi_hw->m[0].timing = timing;
+    for (int i = 0; i < FLASH_TEST_WORDS; i++) {
+        sum = ((sum << 1) | (sum >> 31)) ^ FLASH_UNCACHED[i];
+    }
+    qmi_hw->m[0].timing = old;
+
+    if (sum != expect) {
+        // Filled in here, not from a constant in flash, which can't be
+        // read until XIP is back
+        uint8_t tx[2], rx[2];
+        tx[0] = FLASH_CMD_READ_STATUS;
+        tx[1] = 0;
+        flash_do_cmd(tx, rx, sizeof(tx));
+        qmi_hw->m[0].timing = old;
+    }
+
+    restore_interrupts(save);
+    return sum;
+}
+
+static void __no_inline_not_in_flash_func(flash_set_timing)(uint32_t timing) {
+    uint32_t save = save_and_disable_interrupts();
+    qmi_hw->m[0].timing = timing;
+    restore_interrupts(save);
+}
+
+static bool flash_try(uint32_t timing, uint32_t expect) {
+    for (int pass = 0; pass < TUNE_PASSES; pass++) {
+        if (flash_checksum(timing, expect) != expect) return false;
+    }
+    return true;
+}
+
+// Middle of the longest run of set bits, if at least TUNE_WINDOW long
+static int window_centre(uint32_t pass) {
+    int best_start = -1, best_len = 0;
+    for (int start = 0; start <= MAX_RXDELAY; start++) {
+        int len = 0;
+        while (start + len <= MAX_RXDELAY && (pass & (1u << (start + len)))) len++;
+        if (len > best_len) {
+            best_start = start;
+            best_len = len;
+        }
+    }
+    return best_len >= TUNE_WINDOW ? best_start + best_len / 2 : -1;
+}
+
+static int min_divisor(int clock_hz, int max_mhz) {
+    int divisor = (clock_hz + max_mhz * 1000000 - 1) / (max_mhz * 1000000);
+    return divisor < 2 ? 2 : divisor;
+}
+
+static uint32_t psram_calibrate(void) {
+    const int clock_hz = clock_get_hz(clk_sys);
+    const uint32_t current = qmi_hw->m[1].timing;
+    const int current_div = (current & QMI_M1_TIMING_CLKDIV_BITS) >> QMI_M1_TIMING_CLKDIV_LSB;
+    int divisor, rxdelay = -1;
+
+    for (divisor = min_divisor(clock_hz, QMI_TUNE_PSRAM_MAX_MHZ); divisor <= current_div; divisor++) {
+        uint32_t pass = 0;
+        for (int rx = 0; rx <= MAX_RXDELAY; rx++) {
+            if (psram_try(psram_make_timing(clock_hz, divisor, rx, 1))) pass |= 1u << rx;
+        }
+        rxdelay = window_centre(pass);
+        if (rxdelay >= 0) break;
+    }
+    if (rxdelay < 0) {
+        qmi_hw->m[1].timing = current;
+        return current;
+    }
+
+    // Longer cooldowns let more cache line fills join the same transfer
+    uint32_t best = 0, best_kbs = 0;
+    for (int cooldown = 1; cooldown <= MAX_COOLDOWN; cooldown++) {
+        uint32_t timing = psram_make_timing(clock_hz, divisor, rxdelay, cooldown);
+        uint32_t read_kbs, write_kbs;
+        if (!psram_try(timing)) continue;
+        qmi_tune_bandwidth(&read_kbs, &write_kbs);
+        if (read_kbs + write_kbs > best_kbs) {
+            best = timing;
+            best_kbs = read_kbs + write_kbs;
+        }
+    }
+    if (!best) best = current;
+    qmi_hw->m[1].timing = best;
+    return best;
+}
+
+static uint32_t flash_calibrate(void) {
+    const int clock_hz = clock_get_hz(clk_sys);
+    const uint32_t current = qmi_hw->m[0].timing;
+    const uint32_t fixed = current & ~(QMI_M0_TIMING_RXDELAY_BITS | QMI_M0_TIMING_CLKDIV_BITS);
+    const int current_div = (current & QMI_M0_TIMING_CLKDIV_BITS) >> QMI_M0_TIMING_CLKDIV_LSB;
+    const uint32_t expect = flash_checksum(current, 0);  // reference
+
+    if (!flash_try(current, expect)) return current;
+
+    for (int divisor = min_divisor(clock_hz, QMI_TUNE_FLASH_MAX_MHZ); divisor < current_div; divisor++) {
+        uint32_t pass = 0;
+        for (int rx = 0; rx <= MAX_RXDELAY; rx++) {
+            uint32_t timing = fixed | rx << QMI_M0_TIMING_RXDELAY_LSB | divisor << QMI_M0_TIMING_CLKDIV_LSB;
+            if (flash_try(timing, expect)) pass |= 1u << rx;
+        }
+        int rxdelay = window_centre(pass);
+        if (rxdelay >= 0) {
+            uint32_t timing = fixed | rxdelay << QMI_M0_TIMING_RXDELAY_LSB | divisor << QMI_M0_TIMING_CLKDIV_LSB;
+            flash_set_timing(timing);
+            return timing;
+        }
+    }
+    return current;
+}
+
+void qmi_tune_get(qmi_tune_t *tune) {
+    tune->psram_timing = qmi_hw->m[1].timing;
+    tune->flash_timing = qmi_hw->m[0].timing;
+}
+
+bool qmi_tune_apply(const qmi_tune_t *tune) {
+    const uint32_t psram_old = qmi_hw->m[1].timing;
+    const uint32_t flash_old = qmi_hw->m[0].timing;
+
+    if (!psram_try(tune->psram_timing)) {
+        qmi_hw->m[1].timing = psram_old;
+        return false;
+    }
+    if (tune->flash_timing != flash_old
+        && !flash_try(tune->flash_timing, flash_checksum(flash_old, 0))) {
+        qmi_hw->m[1].timing = psram_old;
+        return false;
+    }
+    flash_set_timing(tune->flash_timing);
+    return true;
+}
+
+void qmi_tune_calibrate(qmi_tune_t *tune) {
+    tune->psram_timing = psram_calibrate();
+    tune->flash_timing = flash_calibrate();
+}
+
+void qmi_tune_bandwidth(uint32_t *read_kbs, uint32_t *write_kbs) {
+    volatile uint32_t *p = PSRAM_CACHED + BANDWIDTH_AREA;
+    uint32_t sink = 0;
+
+    // Sixteen times the cache, so the lines still dirty at the end of the
+    // writes matter little; the reads then push them all out
+    uint32_t start = time_us_32();
+    for (int i = 0; i < BANDWIDTH_WORDS; i++) p[i] = i;
+    uint32_t write_us = time_us_32() - start;
+
+    start = time_us_32();
+    for (int i = 0; i < BANDWIDTH_WORDS; i++) sink += p[i];
+    uint32_t read_us = time_us_32() - start;
+
+    (void)sink;
+    *write_kbs = write_us ? (uint32_t)((uint64_t)BANDWIDTH_WORDS * 4 * 1000000 / 1024 / write_us) : 0;
+    *read_kbs = read_us ? (uint32_t)((uint64_t)BANDWIDTH_WORDS * 4 * 1000000 / 1024 / read_us) : 0;
+}
@@ -0,0 +1,36 @@
+// QMI Timing Calibration
+// Sweeps the QMI clock divisor and read delay of the PSRAM (M1) and
+// flash (M0) windows against a memory test at the running system clock,
+// and keeps the fastest setting that passes with a margin of read delays
+// on either side. The build-time timings are the fallback.
+//
+// The PSRAM test overwrites PSRAM, and the flash test stops interrupts
+// on the calling core, so this is only for boot: before anything is
+// kept in PSRAM and before core 1 is running code from flash.
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef QMI_TUNE_H
+#define QMI_TUNE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t psram_timing;  // qmi_hw->m[1].timing
+    uint32_t flash_timing;  // qmi_hw->m[0].timing
+} qmi_tune_t;
+
+// Current timings
+void qmi_tune_get(qmi_tune_t *tune);
+
+// Switches to the given timings if they pass the memory test, otherwise
+// keeps the current ones and returns false
+bool qmi_tune_apply(const qmi_tune_t *tune);
+
+// Finds and switches to the fastest timings that pass
+void qmi_tune_calibrate(qmi_tune_t *tune);
+
+// Sequential PSRAM bandwidth through the XIP cache, in KB/s
+void qmi_tune_bandwidth(uint32_t *read_kbs, uint32_t *write_kbs);
+
+#endif // QMI_TUNE_H
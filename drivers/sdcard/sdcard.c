@@ -14,6 +14,8 @@
 #include "ff.h"
 #include "diskio.h"
 
+#include <string.h>
+
 
 /*--------------------------------------------------------------------------
 
@@ -24,6 +26,7 @@
 /* MMC/SD command */
 #define CMD0	(0)			/* GO_IDLE_STATE */
 #define CMD1	(1)			/* SEND_OP_COND (MMC) */
+#define CMD6	(6)			/* SWITCH_FUNC (SDC) */
 #define	ACMD41	(0x80+41)	/* SEND_OP_COND (SDC) */
 #define CMD8	(8)			/* SEND_IF_COND */
 #define CMD9	(9)			/* SEND_CSD */
@@ -42,6 +45,7 @@
 #define CMD38	(38)		/* ERASE */
 #define CMD55	(55)		/* APP_CMD */
 #define CMD58	(58)		/* READ_OCR */
+#define CMD59	(59)		/* CRC_ON_OFF */
 
 /* MMC card type flags (MMC_GET_TYPE) */
 #define CT_MMC         0x01            /* MMC ver 3 */
@@ -51,7 +55,24 @@
 #define CT_BLOCK       0x08            /* Block addressing */
 
 #define CLK_SLOW	(100 * KHZ)
-#define CLK_FAST	(30 * MHZ)
+
+/* Fastest SPI clock tried at mount, if the card is rated for it */
+#ifndef SDCARD_MAX_CLK
+#define SDCARD_MAX_CLK	(50 * MHZ)
+#endif
+
+#define CLK_DEFAULT	(25 * MHZ)	/* Rated clock of default speed mode */
+#define CLK_HIGH	(50 * MHZ)	/* Rated clock of high speed mode */
+
+#define TUNE_SECTORS	8		/* Sectors read per pass of the clock test */
+#define TUNE_PASSES		4		/* Passes needed to accept a clock */
+#define READ_RETRIES	3		/* Retries of a failed read */
+
+/* SPI clocks tried, fastest first */
+static const uint32_t clk_steps[] = {
+	50 * MHZ, 42 * MHZ, 36 * MHZ, 30 * MHZ, 25 * MHZ, 20 * MHZ, 15 * MHZ, 10 * MHZ
+};
+#define NUM_CLK_STEPS	(sizeof(clk_steps) / sizeof(clk_steps[0]))
 
 static volatile
 DSTATUS Stat = STA_NOINIT;	/* Physical drive status */
@@ -59,6 +80,18 @@ DSTATUS Stat = STA_NOINIT;	/* Physical drive status */
 static
 BYTE CardType;			/* Card type flags */
 
+static
+UINT ClkStep;			/* Index of the data transfer clock in clk_steps[] */
+
+static
+int CrcOn;				/* The card checks CRCs, and data block CRCs are verified */
+
+static
+uint16_t crc16_table[256];	/* CRC-16/XMODEM as used for SD data blocks */
+
+static
+sdcard_stats_t Stats;
+
 #ifdef SDCARD_PIO
 pio_spi_inst_t pio_spi = {
 		.pio = SDCARD_PIO,
@@ -71,6 +104,41 @@ static inline uint32_t _millis(void)
 	return to_ms_since_boot(get_absolute_time());
 }
 
+/*-----------------------------------------------------------------------*/
+/* CRC calculation                                                       */
+/*-----------------------------------------------------------------------*/
+
+static void crc16_init(void)
+{
+	for (int i = 0; i < 256; i++) {
+		uint16_t crc = i << 8;
+		for (int j = 0; j < 8; j++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		crc16_table[i] = crc;
+	}
+}
+
+static uint16_t crc16 (const BYTE *buff, UINT len)
+{
+	uint16_t crc = 0;
+	while (len--) crc = (crc << 8) ^ crc16_table[(crc >> 8) ^ *buff++];
+	return crc;
+}
+
+/* CRC7 of a command packet, with the end bit */
+static BYTE crc7 (const BYTE *buff, UINT len)
+{
+	BYTE crc = 0;
+	while (len--) {
+		BYTE d = *buff++;
+		for (int i = 0; i < 8; i++) {
+			crc <<= 1;
+			if ((d ^ crc) & 0x80) crc ^= 0x09;
+			d <<= 1;
+		}
+	}
+	return (crc << 1) | 1;
+}
+
 /*-----------------------------------------------------------------------*/
 /* SPI controls (Platform dependent)                                     */
 /*-----------------------------------------------------------------------*/
@@ -94,13 +162,26 @@ static void FCLK_SLOW(void)
 #endif
 }
 
-static void FCLK_FAST(void)
+/* Sets the SPI clock and returns the one actually used */
+static uint32_t set_clock(uint32_t hz)
 {
 #ifndef SDCARD_PIO
-    spi_set_baudrate(SDCARD_SPI_BUS, CLK_FAST);
+    return spi_set_baudrate(SDCARD_SPI_BUS, hz);
+#else
+    /* The PIO program takes 4 cycles per bit */
+    uint32_t sys = clock_get_hz(clk_sys);
+    float div = (float)sys / (4.0f * hz);
+    if (div < 1.0f) div = 1.0f;
+    pio_sm_set_clkdiv(pio_spi.pio, pio_spi.sm, div);
+    return (uint32_t)(sys / (4.0f * div));
 #endif
 }
 
+static void FCLK_FAST(void)
+{
+    Stats.clock_hz = set_clock(clk_steps[ClkStep]);
+}
+
 static void CS_HIGH(void)
 {
     cs_deselect(SDCARD_PIN_SPI0_CS);
@@ -271,7 +352,7 @@ int rcvr_datablock (	/* 1:OK, 0:Error */
 	UINT btr			/* Data block length (byte) */
 )
 {
-	BYTE token;
+	BYTE token, crc[2];
 
 	const uint32_t timeout = 200;
 	uint32_t t = _millis();
@@ -279,10 +360,18 @@ int rcvr_datablock (	/* 1:OK, 0:Error */
 		token = xchg_spi(0xFF);
 		/* This loop will take a time. Insert rot_rdq() here for multitask envilonment. */
 	} while (token == 0xFF && _millis() < t + timeout);
-	if(token != 0xFE) return 0;		/* Function fails if invalid DataStart token or timeout */
+	if(token != 0xFE) {				/* Function fails if invalid DataStart token or timeout */
+		Stats.timeouts++;
+		return 0;
+	}
 
 	rcvr_spi_multi(buff, btr);		/* Store trailing data to the buffer */
-	xchg_spi(0xFF); xchg_spi(0xFF);			/* Discard CRC */
+	crc[0] = xchg_spi(0xFF); crc[1] = xchg_spi(0xFF);	/* Receive CRC */
+
+	if (CrcOn && crc16(buff, btr) != ((crc[0] << 8) | crc[1])) {
+		Stats.crc_errors++;
+		return 0;
+	}
 
 	return 1;						/* Function succeeded */
 }
@@ -298,7 +387,7 @@ BYTE send_cmd (		/* Return value: R1 resp (bit7==1:Failed to send) */
 	DWORD arg		/* Argument */
 )
 {
-	BYTE n, res;
+	BYTE n, res, buf[5];
 
 
 	if (cmd & 0x80) {	/* Send a CMD55 prior to ACMD<n> */
@@ -314,15 +403,13 @@ BYTE send_cmd (		/* Return value: R1 resp (bit7==1:Failed to send) */
 	}
 
 	/* Send command packet */
-	xchg_spi(0x40 | cmd);				/* Start + command index */
-	xchg_spi((BYTE)(arg >> 24));		/* Argument[31..24] */
-	xchg_spi((BYTE)(arg >> 16));		/* Argument[23..16] */
-	xchg_spi((BYTE)(arg >> 8));			/* Argument[15..8] */
-	xchg_spi((BYTE)arg);				/* Argument[7..0] */
-	n = 0x01;							/* Dummy CRC + Stop */
-	if (cmd == CMD0) n = 0x95;			/* Valid CRC for CMD0(0) */
-	if (cmd == CMD8) n = 0x87;			/* Valid CRC for CMD8(0x1AA) */
-	xchg_spi(n);
+	buf[0] = 0x40 | cmd;				/* Start + command index */
+	buf[1] = (BYTE)(arg >> 24);			/* Argument[31..24] */
+	buf[2] = (BYTE)(arg >> 16);			/* Argument[23..16] */
+	buf[3] = (BYTE)(arg >> 8);			/* Argument[15..8] */
+	buf[4] = (BYTE)arg;					/* Argument[7..0] */
+	for (n = 0; n < 5; n++) xchg_spi(buf[n]);
+	xchg_spi(crc7(buf, 5));				/* Valid CRC + Stop, needed once CRCs are on */
 
 	/* Receive command resp */
 	if (cmd == CMD12) xchg_spi(0xFF);	/* Diacard following one byte when CMD12 */
@@ -334,12 +421,163 @@ BYTE send_cmd (		/* Return value: R1 resp (bit7==1:Failed to send) */
 	return res;							/* Return received response */
 }
 
+/*-----------------------------------------------------------------------*/
+/* Read sectors, returning how many were read before any error           */
+/*-----------------------------------------------------------------------*/
+
+static
+UINT read_sectors (
+	BYTE *buff,		/* Pointer to the data buffer to store read data */
+	LBA_t sector,	/* Start sector number (LBA) */
+	UINT count		/* Number of sectors to read */
+)
+{
+	UINT done = 0;
+
+	if (!(CardType & CT_BLOCK)) sector *= 512;	/* LBA ot BA conversion (byte addressing cards) */
+
+	if (count == 1) {	/* Single sector read */
+		if ((send_cmd(CMD17, sector) == 0)	/* READ_SINGLE_BLOCK */
+			&& rcvr_datablock(buff, 512)) {
+			done = 1;
+		}
+	}
+	else {				/* Multiple sector read */
+		if (send_cmd(CMD18, sector) == 0) {	/* READ_MULTIPLE_BLOCK */
+			do {
+				if (!rcvr_datablock(buff, 512)) break;
+				buff += 512;
+			} while (++done < count);
+			send_cmd(CMD12, 0);				/* STOP_TRANSMISSION */
+		}
+	}
+	deselect();
+
+	return done;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Clock negotiation                                                     */
+/*-----------------------------------------------------------------------*/
+
+/* Switch an SDv2 card to high speed mode (CMD6), 1:Switched */
+static
+int switch_high_speed (void)
+{
+	BYTE sw[64];
+
+	/* Check function group 1 supports high speed, then switch to it */
+	if (send_cmd(CMD6, 0x00FFFFF1) != 0 || !rcvr_datablock(sw, 64)) {
+		deselect();
+		return 0;
+	}
+	deselect();
+	if (!(sw[13] & 0x02)) return 0;
+
+	if (send_cmd(CMD6, 0x80FFFFF1) != 0 || !rcvr_datablock(sw, 64)) {
+		deselect();
+		return 0;
+	}
+	deselect();
+	return (sw[16] & 0x0F) == 1;
+}
+
+static
+uint32_t sum_block (
+	uint32_t sum,
+	const BYTE *buff
+)
+{
+	for (UINT i = 0; i < 512; i += 4) {
+		sum = (sum << 1 | sum >> 31) ^ (buff[i] | buff[i + 1] << 8 | buff[i + 2] << 16 | (uint32_t)buff[i + 3] << 24);
+	}
+	return sum;
+}
+
+/* Reads the test sectors and sums their contents, 1:OK */
+static
+int read_test (
+	uint32_t *sum
+)
+{
+	BYTE buff[512];
+	uint32_t multi = 0;
+	UINT n;
+
+	*sum = 0;
+	for (n = 0; n < TUNE_SECTORS; n++) {
+		if (read_sectors(buff, n, 1) != 1) return 0;
+		*sum = sum_block(*sum, buff);
+	}
+
+	/* Once more as a single multiple block read, the way lumps are read */
+	if (send_cmd(CMD18, 0) != 0) {
+		deselect();
+		return 0;
+	}
+	for (n = 0; n < TUNE_SECTORS; n++) {
+		if (!rcvr_datablock(buff, 512)) break;
+		multi = sum_block(multi, buff);
+	}
+	send_cmd(CMD12, 0);
+	deselect();
+
+	return n == TUNE_SECTORS && multi == *sum;
+}
+
+/* Picks the fastest clock, up to the card's rating, that reads the test
+   sectors the same as the slowest one does, without CRC errors */
+static
+void tune_clock (void)
+{
+	uint32_t max = (Stats.high_speed ? CLK_HIGH : CLK_DEFAULT);
+	uint32_t ref, sum;
+	UINT step, pass;
+
+	if (max > SDCARD_MAX_CLK) max = SDCARD_MAX_CLK;
+
+	ClkStep = NUM_CLK_STEPS - 1;
+	FCLK_FAST();
+	if (!read_test(&ref)) return;
+
+	for (step = 0; step < NUM_CLK_STEPS - 1; step++) {
+		if (clk_steps[step] > max) continue;
+		ClkStep = step;
+		FCLK_FAST();
+		for (pass = 0; pass < TUNE_PASSES; pass++) {
+			if (!read_test(&sum) || sum != ref) break;
+		}
+		if (pass == TUNE_PASSES) return;
+	}
+
+	ClkStep = NUM_CLK_STEPS - 1;
+	FCLK_FAST();
+}
+
+/* Falls back to the next slower clock after repeated read errors */
+static
+void clock_step_down (void)
+{
+	if (ClkStep < NUM_CLK_STEPS - 1) {
+		ClkStep++;
+		FCLK_FAST();
+		Stats.clock_drops++;
+	}
+}
+
 /*--------------------------------------------------------------------------
 
    Public Functions
 
 ---------------------------------------------------------------------------*/
 
+void sdcard_get_stats(sdcard_stats_t *stats)
+{
+	*stats = Stats;
+}
+
 
 /*-----------------------------------------------------------------------*/
 /* Initialize disk drive                                                 */
@@ -391,8 +629,17 @@ DSTATUS disk_initialize (
 	deselect();
 
 	if (ty) {			/* OK */
-		FCLK_FAST();			/* Set fast clock */
+		crc16_init();
+		memset(&Stats, 0, sizeof(Stats));
+		CrcOn = (send_cmd(CMD59, 1) == 0);	/* Have the card check CRCs, and check its own */
+		deselect();
+		Stats.crc_enabled = CrcOn;
+		if (ty & CT_SD2) Stats.high_speed = switch_high_speed();
 		Stat &= ~STA_NOINIT;	/* Clear STA_NOINIT flag */
+		tune_clock();			/* Set fast clock */
+
+		/* Only count errors from here on */
+		Stats.timeouts = Stats.crc_errors = 0;
 	} else {			/* Failed */
 		Stat = STA_NOINIT;
 	}
@@ -428,27 +675,26 @@ DRESULT disk_read (
 	UINT count		/* Number of sectors to read (1..128) */
 )
 {
+	uint32_t start;
+	UINT done, retry;
+
 	if (drv || !count) return RES_PARERR;		/* Check parameter */
 	if (Stat & STA_NOINIT) return RES_NOTRDY;	/* Check if drive is ready */
 
-	if (!(CardType & CT_BLOCK)) sector *= 512;	/* LBA ot BA conversion (byte addressing cards) */
-
-	if (count == 1) {	/* Single sector read */
-		if ((send_cmd(CMD17, sector) == 0)	/* READ_SINGLE_BLOCK */
-			&& rcvr_datablock(buff, 512)) {
-			count = 0;
-		}
+	start = time_us_32();
+	for (retry = 0; ; retry++) {
+		done = read_sectors(buff, sector, count);	/* Continue after the sectors already read */
+		Stats.sectors_read += done;
+		buff += done * 512;
+		sector += done;
+		count -= done;
+		if (!count || retry == READ_RETRIES) break;
+
+		Stats.retries++;
+		sleep_us(100u << retry);		/* Back off */
+		if (retry) clock_step_down();	/* Failed again: slow down */
 	}
-	else {				/* Multiple sector read */
-		if (send_cmd(CMD18, sector) == 0) {	/* READ_MULTIPLE_BLOCK */
-			do {
-				if (!rcvr_datablock(buff, 512)) break;
-				buff += 512;
-			} while (--count);
-			send_cmd(CMD12, 0);				/* STOP_TRANSMISSION */
-		}
-	}
-	deselect();
+	Stats.read_us += time_us_32() - start;
 
 	return count ? RES_ERROR : RES_OK;	/* Return result */
 }
@@ -490,13 +736,16 @@ int xmit_datablock (	/* 1:OK, 0:Error */
 )
 {
 	BYTE resp;
+	uint16_t crc;
 	if (!wait_ready(500)) return 0;
 	xchg_spi(token); /* Xmit data token */
 	if (token != 0xFD) { /* Is data token */
 		xmit_spi_multi(buff, 512); /* Xmit the data block to the MMC */
-		xchg_spi(0xFF); /* CRC (Dummy) */
-		xchg_spi(0xFF);
+		crc = crc16(buff, 512); /* CRC, checked by the card once CRCs are on */
+		xchg_spi(crc >> 8);
+		xchg_spi(crc);
 		resp = xchg_spi(0xFF); /* Reveive data response */
+		if ((resp & 0x1F) == 0x0B) Stats.crc_errors++;
 		if ((resp & 0x1F) != 0x05) /* If not accepted, return with error */
 			return 0;
 	}
@@ -556,7 +805,7 @@ DRESULT disk_ioctl (
 )
 {
 	DRESULT res;
-	BYTE n, csd[16];
+	BYTE n, csd[16], sds[64];
 	DWORD *dp, st, ed, csize;
 
 
@@ -588,9 +837,8 @@ DRESULT disk_ioctl (
 		if (CardType & CT_SD2) {	/* SDC ver 2.00 */
 			if (send_cmd(ACMD13, 0) == 0) {	/* Read SD status */
 				xchg_spi(0xFF);
-				if (rcvr_datablock(csd, 16)) {				/* Read partial block */
-					for (n = 64 - 16; n; n--) xchg_spi(0xFF);	/* Purge trailing data */
-					*(DWORD*)buff = 16UL << (csd[10] >> 4);
+				if (rcvr_datablock(sds, 64)) {				/* Read the whole block, so its CRC can be checked */
+					*(DWORD*)buff = 16UL << (sds[10] >> 4);
 					res = RES_OK;
 				}
 			}
@@ -1,6 +1,8 @@
 #ifndef _SDCARD_H_
 #define _SDCARD_H_
 
+#include <stdint.h>
+
 /* SPI pin assignment */
 
 /* Pico Wireless */
@@ -24,4 +26,19 @@
 #define SDCARD_PIN_SPI0_MISO   4
 #endif
 
+/* Transfer statistics, since the card was initialized */
+typedef struct {
+    uint32_t clock_hz;      /* SPI clock negotiated at mount */
+    uint8_t high_speed;     /* card switched to high speed mode */
+    uint8_t crc_enabled;    /* data block CRCs are checked */
+    uint32_t sectors_read;
+    uint64_t read_us;       /* time spent in disk_read */
+    uint32_t crc_errors;
+    uint32_t timeouts;      /* no data token in time */
+    uint32_t retries;       /* reads retried after an error */
+    uint32_t clock_drops;   /* clock lowered after repeated errors */
+} sdcard_stats_t;
+
+void sdcard_get_stats(sdcard_stats_t *stats);
+
 #endif // _SDCARD_H_
@@ -8,6 +8,8 @@
 
 #include "tusb.h"
 #include "usbhid.h"
+#include "input_ring.h"
+#include "pico/time.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -33,39 +35,27 @@ static hid_keyboard_report_t prev_kbd_report = { 0, 0, {0} };
 // Previous mouse report for detecting button changes  
 static hid_mouse_report_t prev_mouse_report = { 0 };
 
-// Accumulated mouse movement
-static volatile int16_t cumulative_dx = 0;
-static volatile int16_t cumulative_dy = 0;
-static volatile int8_t cumulative_wheel = 0;
-static volatile uint8_t current_buttons = 0;
-static volatile int mouse_has_motion = 0;
+// Mouse reports queued by the host task, drained by usbhid_get_mouse_state()
+static input_ring_t mouse_ring;
+static uint8_t current_buttons = 0;
 
 // Device connection state
 static volatile int keyboard_connected = 0;
 static volatile int mouse_connected = 0;
 
-// Key action queue (for detecting press/release)
-#define KEY_ACTION_QUEUE_SIZE 32
-typedef struct {
-    uint8_t keycode;
-    int down;
-} key_action_t;
-
-static key_action_t key_action_queue[KEY_ACTION_QUEUE_SIZE];
-static volatile int key_action_head = 0;
-static volatile int key_action_tail = 0;
+// Key actions (press/release), queued by the host task
+static input_ring_t key_ring;
 
 //--------------------------------------------------------------------
 // Internal functions
 //--------------------------------------------------------------------
 
 static void queue_key_action(uint8_t keycode, int down) {
-    int next_head = (key_action_head + 1) % KEY_ACTION_QUEUE_SIZE;
-    if (next_head != key_action_tail) {
-        key_action_queue[key_action_head].keycode = keycode;
-        key_action_queue[key_action_head].down = down;
-        key_action_head = next_head;
-    }
+    input_event_t ev = { 0 };
+    ev.time_us = time_us_32();
+    ev.type = down ? INPUT_EVENT_KEYDOWN : INPUT_EVENT_KEYUP;
+    ev.code = keycode;
+    input_ring_push(&key_ring, &ev);
 }
 
 static int find_keycode_in_report(hid_keyboard_report_t const *report, uint8_t keycode) {
@@ -134,14 +124,14 @@ static void process_kbd_report(hid_keyboard_report_t const *report, hid_keyboard
 static void process_mouse_report(hid_mouse_report_t const *report) {
     // Standard boot protocol mouse report
     // Note: Y axis inverted for DOOM (positive Y = forward in game)
-    cumulative_dx += report->x;
-    cumulative_dy += -report->y;  // Invert Y for correct forward/back
-    cumulative_wheel += report->wheel;
-    current_buttons = report->buttons & 0x07;
-    
-    if (report->x != 0 || report->y != 0) {
-        mouse_has_motion = 1;
-    }
+    input_event_t ev;
+    ev.time_us = time_us_32();
+    ev.type = INPUT_EVENT_MOTION;
+    ev.code = report->buttons & 0x07;
+    ev.dx = report->x;
+    ev.dy = -report->y;  // Invert Y for correct forward/back
+    ev.wheel = report->wheel;
+    input_ring_push(&mouse_ring, &ev);
     
     prev_mouse_report = *report;
 }
@@ -265,13 +255,9 @@ void usbhid_init(void) {
     // Clear state
     memset(&prev_kbd_report, 0, sizeof(prev_kbd_report));
     memset(&prev_mouse_report, 0, sizeof(prev_mouse_report));
-    cumulative_dx = 0;
-    cumulative_dy = 0;
-    cumulative_wheel = 0;
     current_buttons = 0;
-    mouse_has_motion = 0;
-    key_action_head = 0;
-    key_action_tail = 0;
+    input_ring_init(&mouse_ring);
+    input_ring_init(&key_ring);
 }
 
 void usbhid_task(void) {
@@ -291,34 +277,38 @@ void usbhid_get_keyboard_state(usbhid_keyboard_state_t *state) {
     if (state) {
         memcpy(state->keycode, prev_kbd_report.keycode, 6);
         state->modifier = prev_kbd_report.modifier;
-        state->has_key = (key_action_head != key_action_tail);
+        state->has_key = (key_ring.head != key_ring.tail);
     }
 }
 
 void usbhid_get_mouse_state(usbhid_mouse_state_t *state) {
     if (state) {
-        state->dx = cumulative_dx;
-        state->dy = cumulative_dy;
-        state->wheel = cumulative_wheel;
-        state->buttons = current_buttons;
-        state->has_motion = mouse_has_motion;
+        // Accumulate all reports queued since the last call
+        input_event_t ev;
+        int dx = 0, dy = 0, wheel = 0;
+        while (input_ring_pop(&mouse_ring, &ev)) {
+            dx += ev.dx;
+            dy += ev.dy;
+            wheel += ev.wheel;
+            current_buttons = ev.code;
+        }
         
-        // Reset accumulated values
-        cumulative_dx = 0;
-        cumulative_dy = 0;
-        cumulative_wheel = 0;
-        mouse_has_motion = 0;
+        state->dx = (int16_t)(dx > INT16_MAX ? INT16_MAX : dx < INT16_MIN ? INT16_MIN : dx);
+        state->dy = (int16_t)(dy > INT16_MAX ? INT16_MAX : dy < INT16_MIN ? INT16_MIN : dy);
+        state->wheel = (int8_t)(wheel > INT8_MAX ? INT8_MAX : wheel < INT8_MIN ? INT8_MIN : wheel);
+        state->buttons = current_buttons;
+        state->has_motion = (dx != 0 || dy != 0);
     }
 }
 
 int usbhid_get_key_action(uint8_t *keycode, int *down) {
-    if (key_action_head == key_action_tail) {
+    input_event_t ev;
+    if (!input_ring_pop(&key_ring, &ev)) {
         return 0; // No actions queued
     }
     
-    *keycode = key_action_queue[key_action_tail].keycode;
-    *down = key_action_queue[key_action_tail].down;
-    key_action_tail = (key_action_tail + 1) % KEY_ACTION_QUEUE_SIZE;
+    *keycode = ev.code;
+    *down = ev.type == INPUT_EVENT_KEYDOWN;
     return 1;
 }
 
@@ -24,8 +24,15 @@ extern void D_PostEvent(event_t *ev);
 // Track previous button state to detect changes
 static uint8_t prev_usb_buttons = 0;
 
+// Motion pulled out early by usbhid_wrapper_latch(), posted by the next tick,
+// and the last button change it saw (-1 = none)
+static int latched_usb_dx = 0;
+static int latched_usb_dy = 0;
+static int latched_usb_wheel = 0;
+static int latched_usb_buttons = -1;
+
 // Clamp value to range
-static inline int16_t clamp_delta(int16_t val, int16_t max_val) {
+static inline int16_t clamp_delta(int val, int16_t max_val) {
     if (val > max_val) return max_val;
     if (val < -max_val) return -max_val;
     return val;
@@ -108,6 +115,35 @@ void usbhid_wrapper_init(void) {
     usbhid_init();
     usb_hid_initialized = 1;
     prev_usb_buttons = 0;
+    latched_usb_dx = latched_usb_dy = latched_usb_wheel = 0;
+    latched_usb_buttons = -1;
+#endif
+}
+
+//--------------------------------------------------------------------
+// Latch - Poll mouse motion ahead of the next tick
+//--------------------------------------------------------------------
+
+int usbhid_wrapper_latch(void) {
+#ifdef USB_HID_ENABLED
+    if (!usb_hid_initialized) return 0;
+
+    // Only the mouse is read here; key actions stay queued for the tick
+    usbhid_task();
+
+    usbhid_mouse_state_t mouse;
+    usbhid_get_mouse_state(&mouse);
+    latched_usb_dx += mouse.dx;
+    latched_usb_dy += mouse.dy;
+    latched_usb_wheel += mouse.wheel;
+    if ((mouse.buttons & 0x07) != prev_usb_buttons) {
+        latched_usb_buttons = mouse.buttons & 0x07;
+    }
+
+    // Same scaling the next tick will apply to data2
+    return clamp_delta(latched_usb_dx, MOUSE_MAX_DELTA) * MOUSE_SENSITIVITY_MULT;
+#else
+    return 0;
 #endif
 }
 
@@ -141,6 +177,24 @@ void usbhid_wrapper_tick(void) {
     // Process mouse events
     usbhid_mouse_state_t mouse;
     usbhid_get_mouse_state(&mouse);
+    if (latched_usb_dx || latched_usb_dy || latched_usb_wheel) {
+        mouse.dx = clamp_delta(mouse.dx + latched_usb_dx, INT16_MAX);
+        mouse.dy = clamp_delta(mouse.dy + latched_usb_dy, INT16_MAX);
+        mouse.wheel = clamp_delta(mouse.wheel + latched_usb_wheel, INT8_MAX);
+        latched_usb_dx = latched_usb_dy = latched_usb_wheel = 0;
+    }
+
+    // A button change only the latch saw, already undone, still gets posted
+    if (latched_usb_buttons >= 0 && latched_usb_buttons != prev_usb_buttons
+        && latched_usb_buttons != (mouse.buttons & 0x07)) {
+        event_t ev;
+        ev.type = ev_mouse;
+        ev.data1 = latched_usb_buttons;
+        ev.data2 = ev.data3 = ev.data4 = 0;
+        D_PostEvent(&ev);
+        prev_usb_buttons = latched_usb_buttons;
+    }
+    latched_usb_buttons = -1;
     
     // Only post event if there's actual motion or button change
     // Check for real motion (non-zero deltas) or actual button state change
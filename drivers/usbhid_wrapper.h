@@ -30,6 +30,13 @@ void usbhid_wrapper_init(void);
  */
 void usbhid_wrapper_tick(void);
 
+/**
+ * Poll USB mouse motion ahead of the next tick without posting an event
+ * The motion is kept and posted by the next usbhid_wrapper_tick()
+ * @return Pending turn in ev_mouse data2 units
+ */
+int usbhid_wrapper_latch(void);
+
 /**
  * Check if USB keyboard is connected
  * @return Non-zero if a USB keyboard is connected
@@ -47,6 +54,7 @@ int usbhid_wrapper_mouse_connected(void);
 // Stub functions when USB HID is disabled
 static inline void usbhid_wrapper_init(void) {}
 static inline void usbhid_wrapper_tick(void) {}
+static inline int usbhid_wrapper_latch(void) { return 0; }
 static inline int usbhid_wrapper_keyboard_connected(void) { return 0; }
 static inline int usbhid_wrapper_mouse_connected(void) { return 0; }
 
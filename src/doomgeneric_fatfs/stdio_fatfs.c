@@ -1,44 +1,186 @@
 #include "ff.h"
 #include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <string.h>
 
+#ifndef STDIO_BUFFER_SRAM
+#include "psram_allocator.h"
+#endif
+
 // Map FILE* to FIL* for FatFS
 // We'll use a simple array of file handles
 #define MAX_OPEN_FILES 8
 
+// Bytes buffered per open file; 0 reads and writes straight through
+#ifndef STDIO_BUFFER_SIZE
+#define STDIO_BUFFER_SIZE 4096
+#endif
+
+#if !defined(STDIO_BUFFER_SRAM) && MAX_OPEN_FILES * STDIO_BUFFER_SIZE > 256 * 1024
+#error "STDIO_BUFFER_SIZE too large for the PSRAM file buffer"
+#endif
+
+// Each handle's buffer holds either data read ahead, from base to
+// base + len, with the caller at base + pos and FatFs at base + len, or
+// data not yet written, from base to base + pos, with FatFs at base.
 typedef struct {
     FIL fil;
     int in_use;
+    BYTE *buf;
+    UINT size;
+    UINT len;
+    UINT pos;
+    int dirty;
+    int eof;
+    FSIZE_t base;
 } file_handle_t;
 
 static file_handle_t file_handles[MAX_OPEN_FILES];
 
-// Convert FIL* back to FILE* (just cast the address)
-static FILE* fil_to_file(FIL *fil) {
-    return (FILE*)fil;
+// Streams that aren't ours (stdout, stderr) go to the C library
+int __real_fputc(int c, FILE *fp);
+int __real_fputs(const char *s, FILE *fp);
+char *__real_fgets(char *s, int n, FILE *fp);
+int __real_vfprintf(FILE *fp, const char *format, va_list ap);
+int __real_fflush(FILE *fp);
+int __real_feof(FILE *fp);
+int __real_ungetc(int c, FILE *fp);
+size_t __real_fwrite(const void *ptr, size_t size, size_t nmemb, FILE *fp);
+
+// Convert a handle to FILE* (just cast the address)
+static FILE* handle_to_file(file_handle_t *h) {
+    return (FILE*)h;
+}
+
+// Convert FILE* to a handle, NULL if it isn't one of ours
+static file_handle_t* file_to_handle(FILE *fp) {
+    file_handle_t *h = (file_handle_t*)fp;
+    if (h < file_handles || h >= file_handles + MAX_OPEN_FILES) return NULL;
+    if ((char*)h != (char*)&file_handles[h - file_handles]) return NULL;
+    return h->in_use ? h : NULL;
+}
+
+static BYTE *alloc_buffer(int i) {
+#ifdef STDIO_BUFFER_SRAM
+    return malloc(STDIO_BUFFER_SIZE);
+#else
+    BYTE *pool = psram_get_file_buffer(MAX_OPEN_FILES * STDIO_BUFFER_SIZE);
+    return pool ? pool + i * STDIO_BUFFER_SIZE : NULL;
+#endif
+}
+
+static void free_buffer(BYTE *buf) {
+#ifdef STDIO_BUFFER_SRAM
+    free(buf);
+#endif
+}
+
+// Write out pending data
+static int flush_write(file_handle_t *h) {
+    UINT n = h->pos;
+    UINT bw;
+    FRESULT fr;
+
+    if (!h->dirty) return 0;
+    fr = f_write(&h->fil, h->buf, n, &bw);
+    h->base += bw;
+    h->pos = 0;
+    h->dirty = 0;
+    return (fr == FR_OK && bw == n) ? 0 : EOF;
+}
+
+// Drop data read ahead, moving FatFs back to the caller's position
+static int drop_read(file_handle_t *h) {
+    FRESULT fr = FR_OK;
+
+    if (h->len == 0) return 0;
+    if (h->pos != h->len) fr = f_lseek(&h->fil, h->base + h->pos);
+    h->base += h->pos;
+    h->len = h->pos = 0;
+    return fr == FR_OK ? 0 : EOF;
+}
+
+static size_t read_buffered(file_handle_t *h, BYTE *dst, size_t n) {
+    size_t done = 0;
+    UINT br;
+
+    if (h->dirty && flush_write(h)) return 0;
+
+    while (n > 0) {
+        UINT avail = h->len - h->pos;
+
+        if (avail > 0) {
+            if (avail > n) avail = n;
+            memcpy(dst, h->buf + h->pos, avail);
+            h->pos += avail;
+            dst += avail;
+            done += avail;
+            n -= avail;
+            continue;
+        }
+
+        h->base += h->len;
+        h->len = h->pos = 0;
+
+        if (n >= h->size) {
+            // Large reads go straight to the caller
+            if (f_read(&h->fil, dst, n, &br) != FR_OK) br = 0;
+            h->base += br;
+            done += br;
+            if (br < n) h->eof = 1;
+            break;
+        }
+
+        if (f_read(&h->fil, h->buf, h->size, &br) != FR_OK) br = 0;
+        h->len = br;
+        if (br == 0) {
+            h->eof = 1;
+            break;
+        }
+    }
+
+    return done;
 }
 
-// Convert FILE* to FIL*
-static FIL* file_to_fil(FILE *fp) {
-    return (FIL*)fp;
+static size_t write_buffered(file_handle_t *h, const BYTE *src, size_t n) {
+    UINT bw;
+
+    if (n == 0) return 0;
+    if (h->len && drop_read(h)) return 0;
+
+    if (h->pos + n > h->size) {
+        if (flush_write(h)) return 0;
+        if (n >= h->size) {
+            if (f_write(&h->fil, src, n, &bw) != FR_OK) bw = 0;
+            h->base += bw;
+            return bw;
+        }
+    }
+
+    memcpy(h->buf + h->pos, src, n);
+    h->pos += n;
+    h->dirty = 1;
+    return n;
 }
 
 FILE *__wrap_fopen(const char *filename, const char *mode) {
     BYTE fatfs_mode = 0;
     FRESULT fr;
+    file_handle_t *h;
     int i;
-    
+
     // Find free handle
     for (i = 0; i < MAX_OPEN_FILES; i++) {
         if (!file_handles[i].in_use) break;
     }
-    
+
     if (i >= MAX_OPEN_FILES) {
         errno = ENOMEM;
         return NULL;
     }
-    
+
     // Parse mode
     if (strchr(mode, 'r')) {
         fatfs_mode = FA_READ;
@@ -50,92 +192,229 @@ FILE *__wrap_fopen(const char *filename, const char *mode) {
         fatfs_mode = FA_WRITE | FA_OPEN_APPEND;
         if (strchr(mode, '+')) fatfs_mode |= FA_READ;
     }
-    
-    fr = f_open(&file_handles[i].fil, filename, fatfs_mode);
-    
+
+    h = &file_handles[i];
+    fr = f_open(&h->fil, filename, fatfs_mode);
+
     if (fr != FR_OK) {
         errno = EIO;
         return NULL;
     }
-    
-    file_handles[i].in_use = 1;
-    return fil_to_file(&file_handles[i].fil);
+
+    h->buf = STDIO_BUFFER_SIZE ? alloc_buffer(i) : NULL;
+    h->size = h->buf ? STDIO_BUFFER_SIZE : 0;
+    h->len = h->pos = 0;
+    h->dirty = h->eof = 0;
+    h->base = f_tell(&h->fil);
+    h->in_use = 1;
+    return handle_to_file(h);
 }
 
 int __wrap_fclose(FILE *fp) {
-    FIL *fil = file_to_fil(fp);
-    int i;
-    
-    // Find the handle
-    for (i = 0; i < MAX_OPEN_FILES; i++) {
-        if (file_handles[i].in_use && &file_handles[i].fil == fil) {
-            f_close(fil);
-            file_handles[i].in_use = 0;
-            return 0;
-        }
-    }
-    
-    return EOF;
+    file_handle_t *h = file_to_handle(fp);
+    int res;
+
+    if (!h) return EOF;
+
+    res = flush_write(h);
+    if (f_close(&h->fil) != FR_OK) res = EOF;
+    free_buffer(h->buf);
+    h->in_use = 0;
+    return res;
 }
 
 size_t __wrap_fread(const void *ptr, size_t size, size_t nmemb, FILE *fp) {
-    FIL *fil = file_to_fil(fp);
-    UINT br;
-    FRESULT fr;
-    
-    fr = f_read(fil, (void*)ptr, size * nmemb, &br);
-    if (fr != FR_OK) return 0;
-    
-    return br / size;
+    file_handle_t *h = file_to_handle(fp);
+
+    if (!h || size == 0) return 0;
+    return read_buffered(h, (BYTE*)ptr, size * nmemb) / size;
 }
 
 int __wrap_fgetc(FILE *fp) {
-    FIL *fil = file_to_fil(fp);
-    UINT br;
-    FRESULT fr;
+    file_handle_t *h = file_to_handle(fp);
     unsigned char c;
-    
-    fr = f_read(fil, &c, 1, &br);
-    if (fr != FR_OK || br == 0) return EOF;
-    
-    return (int)c;
+
+    if (!h) return EOF;
+    if (!h->dirty && h->pos < h->len) return h->buf[h->pos++];
+    return read_buffered(h, &c, 1) ? (int)c : EOF;
+}
+
+int __wrap_ungetc(int c, FILE *fp) {
+    file_handle_t *h = file_to_handle(fp);
+
+    if (!h) return __real_ungetc(c, fp);
+
+    // Only a character just read from the buffer can be pushed back
+    if (c == EOF || h->dirty || h->pos == 0) return EOF;
+    h->buf[--h->pos] = (BYTE)c;
+    h->eof = 0;
+    return c;
+}
+
+char *__wrap_fgets(char *s, int n, FILE *fp) {
+    file_handle_t *h = file_to_handle(fp);
+    int i = 0;
+    int c;
+
+    if (!h) return __real_fgets(s, n, fp);
+
+    while (i < n - 1) {
+        c = __wrap_fgetc(fp);
+        if (c == EOF) break;
+        s[i++] = (char)c;
+        if (c == '\n') break;
+    }
+
+    if (i == 0) return NULL;
+    s[i] = '\0';
+    return s;
 }
 
 size_t __wrap_fwrite(const void *ptr, size_t size, size_t nmemb, FILE *fp) {
-    FIL *fil = file_to_fil(fp);
-    UINT bw;
-    FRESULT fr;
-    
-    fr = f_write(fil, ptr, size * nmemb, &bw);
-    if (fr != FR_OK) return 0;
-    
-    return bw / size;
+    file_handle_t *h = file_to_handle(fp);
+
+    if (!h) return __real_fwrite(ptr, size, nmemb, fp);
+    if (size == 0) return 0;
+    return write_buffered(h, ptr, size * nmemb) / size;
+}
+
+int __wrap_fputc(int c, FILE *fp) {
+    file_handle_t *h = file_to_handle(fp);
+    BYTE b = (BYTE)c;
+
+    if (!h) return __real_fputc(c, fp);
+    return write_buffered(h, &b, 1) ? b : EOF;
+}
+
+int __wrap_fputs(const char *s, FILE *fp) {
+    file_handle_t *h = file_to_handle(fp);
+    size_t len = strlen(s);
+
+    if (!h) return __real_fputs(s, fp);
+    return write_buffered(h, (const BYTE*)s, len) == len ? 0 : EOF;
+}
+
+int __wrap_vfprintf(FILE *fp, const char *format, va_list ap) {
+    file_handle_t *h = file_to_handle(fp);
+    char line[128];
+    char *text = line;
+    va_list ap2;
+    int len;
+
+    if (!h) return __real_vfprintf(fp, format, ap);
+
+    va_copy(ap2, ap);
+    len = vsnprintf(line, sizeof(line), format, ap);
+    if (len >= (int)sizeof(line)) {
+        text = malloc(len + 1);
+        if (text) vsnprintf(text, len + 1, format, ap2);
+    }
+    va_end(ap2);
+
+    if (len < 0 || !text) return -1;
+    if (write_buffered(h, (const BYTE*)text, len) != (size_t)len) len = -1;
+    if (text != line) free(text);
+    return len;
+}
+
+int __wrap_fprintf(FILE *fp, const char *format, ...) {
+    va_list ap;
+    int len;
+
+    va_start(ap, format);
+    len = __wrap_vfprintf(fp, format, ap);
+    va_end(ap);
+    return len;
+}
+
+// Each call parses one line, skipping lines that are only white space
+// as a leading conversion would.  Enough for the line-per-record formats
+// config files use.
+int __wrap_fscanf(FILE *fp, const char *format, ...) {
+    file_handle_t *h = file_to_handle(fp);
+    char line[256];
+    va_list ap;
+    int res = EOF;
+
+    va_start(ap, format);
+    if (!h) {
+        res = vfscanf(fp, format, ap);
+    } else {
+        while (__wrap_fgets(line, sizeof(line), fp)) {
+            if (line[strspn(line, " \t\r\n")] != '\0') {
+                res = vsscanf(line, format, ap);
+                break;
+            }
+        }
+    }
+    va_end(ap);
+    return res;
+}
+
+int __wrap_fflush(FILE *fp) {
+    file_handle_t *h;
+    int res = 0;
+    int i;
+
+    if (fp == NULL) {
+        for (i = 0; i < MAX_OPEN_FILES; i++) {
+            if (file_handles[i].in_use && flush_write(&file_handles[i])) res = EOF;
+        }
+        return __real_fflush(NULL) ? EOF : res;
+    }
+
+    h = file_to_handle(fp);
+    if (!h) return __real_fflush(fp);
+    return flush_write(h);
+}
+
+int __wrap_feof(FILE *fp) {
+    file_handle_t *h = file_to_handle(fp);
+
+    if (!h) return __real_feof(fp);
+    return h->eof && h->pos == h->len;
 }
 
 int __wrap_fseek(FILE *fp, long offset, int whence) {
-    FIL *fil = file_to_fil(fp);
+    file_handle_t *h = file_to_handle(fp);
     FSIZE_t pos;
-    
+
+    if (!h) return -1;
+
     switch (whence) {
         case SEEK_SET:
             pos = offset;
             break;
         case SEEK_CUR:
-            pos = f_tell(fil) + offset;
+            pos = h->base + h->pos + offset;
             break;
         case SEEK_END:
-            pos = f_size(fil) + offset;
+            if (flush_write(h)) return -1;
+            pos = f_size(&h->fil) + offset;
             break;
         default:
             return -1;
     }
-    
-    return (f_lseek(fil, pos) == FR_OK) ? 0 : -1;
+
+    h->eof = 0;
+
+    // Within the data already read ahead, only the buffer position moves
+    if (!h->dirty && h->len && pos >= h->base && pos <= h->base + h->len) {
+        h->pos = pos - h->base;
+        return 0;
+    }
+
+    if (flush_write(h)) return -1;
+    h->len = h->pos = 0;
+    h->base = pos;
+    return (f_lseek(&h->fil, pos) == FR_OK) ? 0 : -1;
 }
 
 long __wrap_ftell(FILE *fp) {
-    FIL *fil = file_to_fil(fp);
-    return (long)f_tell(fil);
+    file_handle_t *h = file_to_handle(fp);
+
+    if (!h) return -1;
+    return (long)(h->base + h->pos);
 }
 
 int __wrap_remove(const char *filename) {
@@ -1,16 +1,84 @@
+#include <stdio.h>
+#include <string.h>
+
 #include "ff.h"
+#include "diskio.h"
 #include "w_file.h"
 #include "z_zone.h"
 #include "m_misc.h"
 
+// Cluster link map entries tried first: room for 31 fragments
+#define CLMT_INITIAL 64
+
 typedef struct
 {
     wad_file_t wad;
     FIL file;
+    DWORD *clmt;        // cluster link map for fast seeks
+    LBA_t start;        // first sector if the file is contiguous, else 0
 } fatfs_wad_file_t;
 
+// Sector shared by the reads of all files, for the partial sectors at
+// either end of a read.  Consecutive lumps usually share one.
+static BYTE bounce[FF_MAX_SS] __attribute__((aligned(4)));
+static BYTE bounce_drv;
+static LBA_t bounce_lba;
+static boolean bounce_valid;
+
 extern wad_file_class_t stdc_wad_file; // We implement this one
 
+// Builds the cluster link map, so seeks don't walk the FAT chain.  A file
+// in one fragment, as one copied to a freshly formatted card is, is read
+// by sector number without going through FatFs at all.
+
+static void W_FatFs_MapFile(fatfs_wad_file_t *fatfs_wad, const char *path)
+{
+    FIL *file = &fatfs_wad->file;
+    FATFS *fs = file->obj.fs;
+    DWORD *clmt;
+    FRESULT fr;
+
+    fatfs_wad->clmt = NULL;
+    fatfs_wad->start = 0;
+
+    clmt = Z_Malloc(CLMT_INITIAL * sizeof(DWORD), PU_STATIC, 0);
+    clmt[0] = CLMT_INITIAL;
+    file->cltbl = clmt;
+    fr = f_lseek(file, CREATE_LINKMAP);
+
+    if (fr == FR_NOT_ENOUGH_CORE)
+    {
+        // clmt[0] now holds the size needed
+        DWORD needed = clmt[0];
+
+        Z_Free(clmt);
+        clmt = Z_Malloc(needed * sizeof(DWORD), PU_STATIC, 0);
+        clmt[0] = needed;
+        file->cltbl = clmt;
+        fr = f_lseek(file, CREATE_LINKMAP);
+    }
+
+    if (fr != FR_OK)
+    {
+        file->cltbl = NULL;
+        Z_Free(clmt);
+        return;
+    }
+
+    fatfs_wad->clmt = clmt;
+
+    // Table size, one fragment's length and first cluster, terminator
+    if (clmt[0] == 4)
+    {
+        fatfs_wad->start = fs->database + (LBA_t) fs->csize * (clmt[2] - 2);
+    }
+    else if (clmt[0] > 4)
+    {
+        printf("W_FatFs: %s is in %u fragments, copy it to a fresh "
+               "card for faster loading\n", path, (unsigned) (clmt[0] - 2) / 2);
+    }
+}
+
 #ifdef HERETIC
 static wad_file_t *W_FatFs_OpenFile(const char *path)
 #else
@@ -34,6 +102,8 @@ static wad_file_t *W_FatFs_OpenFile(char *path)
     result->wad.mapped = NULL;
     result->wad.length = f_size(&result->file);
 
+    W_FatFs_MapFile(result, path);
+
     return &result->wad;
 }
 
@@ -44,7 +114,94 @@ static void W_FatFs_CloseFile(wad_file_t *wad)
     fatfs_wad = (fatfs_wad_file_t *) wad;
 
     f_close(&fatfs_wad->file);
+    if (fatfs_wad->clmt != NULL)
+    {
+        Z_Free(fatfs_wad->clmt);
+    }
     Z_Free(fatfs_wad);
+
+    // The sectors may belong to another file next time
+    bounce_valid = false;
+}
+
+// Copies part of one sector through the bounce buffer.
+
+static boolean W_FatFs_ReadPartial(BYTE drv, LBA_t lba, unsigned int skip,
+                                   byte *dest, unsigned int len)
+{
+    if (!bounce_valid || bounce_drv != drv || bounce_lba != lba)
+    {
+        bounce_valid = false;
+        if (disk_read(drv, bounce, lba, 1) != RES_OK)
+        {
+            return false;
+        }
+        bounce_drv = drv;
+        bounce_lba = lba;
+        bounce_valid = true;
+    }
+
+    memcpy(dest, bounce + skip, len);
+    return true;
+}
+
+// Read from a contiguous file: whole sectors go straight into the buffer
+// as one multiple block read, and only the ends are bounced.
+
+static size_t W_FatFs_ReadContiguous(fatfs_wad_file_t *fatfs_wad,
+                                     unsigned int offset,
+                                     byte *buffer, size_t buffer_len)
+{
+    BYTE drv = fatfs_wad->file.obj.fs->pdrv;
+    LBA_t lba = fatfs_wad->start + offset / FF_MIN_SS;
+    unsigned int skip = offset % FF_MIN_SS;
+    size_t left, n;
+
+    if (offset >= fatfs_wad->wad.length)
+    {
+        return 0;
+    }
+    if (buffer_len > fatfs_wad->wad.length - offset)
+    {
+        buffer_len = fatfs_wad->wad.length - offset;
+    }
+
+    left = buffer_len;
+
+    if (skip != 0 || left < FF_MIN_SS)
+    {
+        n = FF_MIN_SS - skip;
+        if (n > left)
+        {
+            n = left;
+        }
+        if (!W_FatFs_ReadPartial(drv, lba, skip, buffer, n))
+        {
+            return 0;
+        }
+        buffer += n;
+        left -= n;
+        lba++;
+    }
+
+    n = left / FF_MIN_SS;
+    if (n > 0)
+    {
+        if (disk_read(drv, buffer, lba, n) != RES_OK)
+        {
+            return 0;
+        }
+        buffer += n * FF_MIN_SS;
+        left -= n * FF_MIN_SS;
+        lba += n;
+    }
+
+    if (left > 0 && !W_FatFs_ReadPartial(drv, lba, 0, buffer, left))
+    {
+        return 0;
+    }
+
+    return buffer_len;
 }
 
 size_t W_FatFs_Read(wad_file_t *wad, unsigned int offset,
@@ -56,6 +213,11 @@ size_t W_FatFs_Read(wad_file_t *wad, unsigned int offset,
 
     fatfs_wad = (fatfs_wad_file_t *) wad;
 
+    if (fatfs_wad->start != 0)
+    {
+        return W_FatFs_ReadContiguous(fatfs_wad, offset, buffer, buffer_len);
+    }
+
     f_lseek(&fatfs_wad->file, offset);
     fr = f_read(&fatfs_wad->file, buffer, buffer_len, &br);
 
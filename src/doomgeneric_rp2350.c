@@ -6,9 +6,13 @@
 #include "hardware/gpio.h"
 #include "hardware/spi.h"
 #include "hardware/watchdog.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "hardware/structs/systick.h"
+#include "hardware/clocks.h"
 #include "HDMI.h"
 #include "psram_init.h"
 #include "psram_allocator.h"
+#include "qmi_tune.h"
 #include "sdcard.h"
 #include "ff.h"
 #include "ps2kbd_wrapper.h"
@@ -34,12 +38,87 @@ extern void stdio_fatfs_init(void);
 // Global FatFs object
 FATFS fs;
 
+#if QMI_TUNE
+// Timings found by qmi_tune_calibrate, saved with the system clock they
+// were found at. Delete the file to calibrate again.
+#define QMI_TUNE_FILE "qmitune.cfg"
+
+static void tune_memory_timings(void) {
+    uint32_t clock_hz = clock_get_hz(clk_sys);
+    qmi_tune_t tune;
+    bool cached = false;
+    char line[64];
+    FIL f;
+
+    if (f_open(&f, QMI_TUNE_FILE, FA_READ) == FR_OK) {
+        unsigned long hz, psram, flash;
+        if (f_gets(line, sizeof(line), &f)
+            && sscanf(line, "%lu %lx %lx", &hz, &psram, &flash) == 3
+            && hz == clock_hz) {
+            tune.psram_timing = psram;
+            tune.flash_timing = flash;
+            cached = qmi_tune_apply(&tune);
+        }
+        f_close(&f);
+    }
+
+    if (!cached) {
+        printf("QMI: calibrating memory timings at %lu MHz\n",
+               (unsigned long)(clock_hz / 1000000));
+        qmi_tune_calibrate(&tune);
+        if (f_open(&f, QMI_TUNE_FILE, FA_WRITE | FA_CREATE_ALWAYS) == FR_OK) {
+            UINT bw;
+            int len = snprintf(line, sizeof(line), "%lu %08lx %08lx\n",
+                               (unsigned long)clock_hz,
+                               (unsigned long)tune.psram_timing,
+                               (unsigned long)tune.flash_timing);
+            f_write(&f, line, len, &bw);
+            f_close(&f);
+        }
+    }
+
+    uint32_t read_kbs, write_kbs;
+    qmi_tune_bandwidth(&read_kbs, &write_kbs);
+    printf("QMI: PSRAM timing %08lx, flash timing %08lx (%s)\n",
+           (unsigned long)tune.psram_timing, (unsigned long)tune.flash_timing,
+           cached ? QMI_TUNE_FILE : "calibrated");
+    printf("QMI: PSRAM read %lu KB/s, write %lu KB/s\n",
+           (unsigned long)read_kbs, (unsigned long)write_kbs);
+}
+#endif
+
 void DG_Init() {
     // Initialize PSRAM (pin auto-detected based on chip package)
     uint psram_pin = get_psram_pin();
     psram_init(psram_pin);
     psram_set_sram_mode(0); // Use PSRAM
 
+    // Mount SD Card
+    FRESULT fr = f_mount(&fs, "", 1);
+    if (fr != FR_OK) {
+        panic("Failed to mount SD card");
+    }
+    
+    // Set current directory to root (required for relative paths)
+    f_chdir("/");
+
+    sdcard_stats_t sd;
+    sdcard_get_stats(&sd);
+    printf("SD: %lu kHz, %s speed, CRC %s\n", (unsigned long)(sd.clock_hz / 1000),
+           sd.high_speed ? "high" : "default", sd.crc_enabled ? "checked" : "off");
+
+    printf("PSRAM: %u MB\n", (unsigned)(psram_get_size() / (1024 * 1024)));
+
+#if QMI_TUNE
+    // Overwrites PSRAM, so before anything is allocated there. Tuning is
+    // only worth it on the 8 MB part; anything smaller keeps the defaults.
+    if (psram_get_size() >= 8 * 1024 * 1024) {
+        tune_memory_timings();
+    } else {
+        printf("QMI: less than 8 MB PSRAM, default timings kept\n");
+    }
+#endif
+
     // Allocate screen buffer in PSRAM
     DG_ScreenBuffer = (pixel_t*)psram_malloc(DOOMGENERIC_RESX * DOOMGENERIC_RESY * sizeof(pixel_t));
     if (!DG_ScreenBuffer) {
@@ -53,15 +132,6 @@ void DG_Init() {
     graphics_init(g_out_HDMI);
     graphics_set_res(320, 240);
     graphics_set_buffer((uint8_t*)DG_ScreenBuffer);
-
-    // Mount SD Card
-    FRESULT fr = f_mount(&fs, "", 1);
-    if (fr != FR_OK) {
-        panic("Failed to mount SD card");
-    }
-    
-    // Set current directory to root (required for relative paths)
-    f_chdir("/");
     
     // Initialize stdio wrapper for FatFS
     stdio_fatfs_init();
@@ -77,6 +147,187 @@ void DG_Init() {
 }
 
 extern volatile uint32_t hdmi_irq_count;
+extern volatile uint32_t hdmi_vblank_count;
+
+// Input-to-photon latency of late-latched mouse turns: time from the
+// poll that first saw the motion to the frame showing it being handed
+// to the HDMI scanout buffer. Set INPUT_LATENCY_LOG to print it.
+#ifndef INPUT_LATENCY_LOG
+#define INPUT_LATENCY_LOG 0
+#endif
+
+static uint64_t latch_input_us;     // 0 = no unshown motion
+static uint32_t latency_last_us;
+static uint32_t latency_max_us;
+static uint64_t latency_total_us;
+static uint32_t latency_frames;
+
+int DG_LatchMouse(void) {
+    int turn = ps2mouse_wrapper_latch() + usbhid_wrapper_latch();
+    if (turn && !latch_input_us) {
+        latch_input_us = time_us_64();
+    }
+    return turn;
+}
+
+void DG_GetInputLatency(uint32_t *last_us, uint32_t *avg_us, uint32_t *max_us) {
+    *last_us = latency_last_us;
+    *avg_us = latency_frames ? (uint32_t)(latency_total_us / latency_frames) : 0;
+    *max_us = latency_max_us;
+}
+
+static void measure_input_latency(void) {
+    if (!latch_input_us) return;
+    uint64_t now = time_us_64();
+    latency_last_us = (uint32_t)(now - latch_input_us);
+    latch_input_us = 0;
+    if (latency_last_us > latency_max_us) latency_max_us = latency_last_us;
+    latency_total_us += latency_last_us;
+    latency_frames++;
+#if INPUT_LATENCY_LOG
+    if ((latency_frames & 255) == 0) {
+        printf("Input latency: last %lu us, avg %lu us, max %lu us\n",
+               (unsigned long)latency_last_us,
+               (unsigned long)(latency_total_us / latency_frames),
+               (unsigned long)latency_max_us);
+    }
+#endif
+}
+
+// XIP cache hit rate and time per frame, to see what moving data out of
+// flash and PSRAM buys. Set XIP_CACHE_LOG to print them.
+#ifndef XIP_CACHE_LOG
+#define XIP_CACHE_LOG 0
+#endif
+
+static uint32_t xip_hit_permille;   // last frame
+static uint32_t xip_frame_us;       // last frame
+static uint64_t xip_last_frame_us;
+static uint32_t xip_frames;
+
+void DG_GetXipCacheStats(uint32_t *hit_permille, uint32_t *frame_us) {
+    *hit_permille = xip_hit_permille;
+    *frame_us = xip_frame_us;
+}
+
+static void measure_xip_cache(void) {
+    uint32_t hit = xip_ctrl_hw->ctr_hit;
+    uint32_t acc = xip_ctrl_hw->ctr_acc;
+    uint64_t now = time_us_64();
+
+    // Writing either counter clears it
+    xip_ctrl_hw->ctr_hit = 0;
+    xip_ctrl_hw->ctr_acc = 0;
+
+    xip_hit_permille = acc ? (uint32_t)((uint64_t)hit * 1000 / acc) : 1000;
+    xip_frame_us = xip_last_frame_us ? (uint32_t)(now - xip_last_frame_us) : 0;
+    xip_last_frame_us = now;
+    xip_frames++;
+#if XIP_CACHE_LOG
+    if ((xip_frames & 255) == 0) {
+        printf("XIP cache: %lu.%lu%% hits, frame %lu us\n",
+               (unsigned long)(xip_hit_permille / 10),
+               (unsigned long)(xip_hit_permille % 10),
+               (unsigned long)xip_frame_us);
+    }
+#endif
+}
+
+// Time the HDMI scanout interrupt takes from the core that owns it, per
+// frame. Set HDMI_IRQ_LOG to print it.
+#ifndef HDMI_IRQ_LOG
+#define HDMI_IRQ_LOG 0
+#endif
+
+#if HDMI_IRQ_LOG
+static void measure_hdmi_irq(void) {
+    static uint32_t frames;
+    if ((++frames & 255) != 0) return;
+
+    uint32_t irqs, cycles;
+    graphics_get_irq_stats(&irqs, &cycles);
+    uint32_t frame_cycles = clock_get_hz(clk_sys) / graphics_get_video_mode(0).freq;
+    uint32_t permille = (uint32_t)((uint64_t)cycles * 1000 / frame_cycles);
+    printf("HDMI IRQ: %lu per frame, %lu cycles, %lu.%lu%% of the core\n",
+           (unsigned long)irqs, (unsigned long)cycles,
+           (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+}
+#endif
+
+// Sampled PC profile of core 0 for tools/hot_functions.py. SysTick
+// records the interrupted PC into a PSRAM buffer from the first frame
+// on; once it is full the samples are written to pcprof.bin on the SD
+// card as little-endian 32-bit words. Build with PC_PROFILE to enable.
+#ifndef PC_PROFILE
+#define PC_PROFILE 0
+#endif
+
+#if PC_PROFILE
+#ifndef PC_PROFILE_HZ
+#define PC_PROFILE_HZ 1000
+#endif
+#ifndef PC_PROFILE_SAMPLES
+#define PC_PROFILE_SAMPLES 65536
+#endif
+
+static uint32_t *pcprof_buf;
+static volatile uint32_t pcprof_count;
+static bool pcprof_written;
+
+void __not_in_flash_func(pc_profile_sample)(const uint32_t *frame) {
+    // Stacked exception frame: r0-r3, r12, lr, pc, xpsr
+    if (pcprof_count < PC_PROFILE_SAMPLES) {
+        pcprof_buf[pcprof_count++] = frame[6];
+    } else {
+        systick_hw->csr = 0;
+    }
+}
+
+void __attribute__((naked)) __not_in_flash_func(isr_systick)(void) {
+    // EXC_RETURN bit 2 says which stack holds the frame
+    __asm volatile(
+        "tst lr, #4\n"
+        "ite eq\n"
+        "mrseq r0, msp\n"
+        "mrsne r0, psp\n"
+        "b pc_profile_sample\n");
+}
+
+static void pc_profile_start(void) {
+    pcprof_buf = (uint32_t*)psram_malloc(PC_PROFILE_SAMPLES * sizeof(uint32_t));
+    if (!pcprof_buf) {
+        printf("PC profile: no memory for %d samples\n", PC_PROFILE_SAMPLES);
+        pcprof_written = true;
+        return;
+    }
+    pcprof_count = 0;
+    systick_hw->rvr = clock_get_hz(clk_sys) / PC_PROFILE_HZ - 1;
+    systick_hw->cvr = 0;
+    // Processor clock, interrupt, enable
+    systick_hw->csr = 7;
+    printf("PC profile: sampling %d Hz into %d samples\n",
+           PC_PROFILE_HZ, PC_PROFILE_SAMPLES);
+}
+
+static void pc_profile_frame(void) {
+    if (pcprof_written) return;
+    if (!pcprof_buf) {
+        pc_profile_start();
+        return;
+    }
+    if (pcprof_count < PC_PROFILE_SAMPLES) return;
+
+    // Written from the game loop; FatFs must not run in the IRQ
+    pcprof_written = true;
+    FIL f;
+    UINT bw = 0;
+    if (f_open(&f, "pcprof.bin", FA_WRITE | FA_CREATE_ALWAYS) == FR_OK) {
+        f_write(&f, pcprof_buf, PC_PROFILE_SAMPLES * sizeof(uint32_t), &bw);
+        f_close(&f);
+    }
+    printf("PC profile: wrote %u bytes to pcprof.bin\n", (unsigned)bw);
+}
+#endif
 
 void DG_DrawFrame() {
     if (palette_changed) {
@@ -86,6 +337,22 @@ void DG_DrawFrame() {
         }
         palette_changed = false;
     }
+    measure_input_latency();
+    measure_xip_cache();
+#if HDMI_IRQ_LOG
+    measure_hdmi_irq();
+#endif
+#if PC_PROFILE
+    pc_profile_frame();
+#endif
+}
+
+// Waits for the scanout to leave the visible lines
+void DG_WaitVBlank(void) {
+    uint32_t count = hdmi_vblank_count;
+    while (hdmi_vblank_count == count) {
+        tight_loop_contents();
+    }
 }
 
 void DG_SleepMs(uint32_t ms) {
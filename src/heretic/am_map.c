@@ -22,6 +22,7 @@
 #include "deh_str.h"
 #include "i_timer.h"
 #include "i_video.h"
+#include "m_bbox.h"
 #include "m_controls.h"
 #include "p_local.h"
 #include "am_map.h"
@@ -159,6 +160,24 @@ static byte *maplump;           // pointer to the raw data for the automap backg
 static short mapystart = 0;     // y-value for the start of the map bitmap...used in the paralax stuff.
 static short mapxstart = 0;     //x-value for the bitmap.
 
+// Screen positions of the map vertexes, computed when a line using the
+// vertex is first drawn after the window moves or zooms (amviewstamp).
+typedef struct
+{
+    int x, y;
+    unsigned int stamp;
+} amvertex_t;
+
+static amvertex_t *amvertexes;          // [numvertexes], PU_LEVEL
+static unsigned int *amvisiblelines;    // [numlines] bits, PU_LEVEL
+static unsigned int amviewstamp;
+static fixed_t amview_x, amview_y, amview_scale;
+
+// Edge fade added to the line colour index near the window borders,
+// indexed by x + 1 and y, see PUTDOT
+static byte amfadex[SCREENWIDTH + 2];
+static byte amfadey[SCREENHEIGHT + 1];
+
 //byte screens[][SCREENWIDTH*SCREENHEIGHT];
 //void V_MarkRect (int x, int y, int width, int height);
 
@@ -446,6 +465,30 @@ void AM_LevelInit(void)
     scale_ftom = FixedDiv(FRACUNIT, scale_mtof);
 }
 
+static void AM_initFade(void)
+{
+    int i;
+
+    for (i = -1; i <= SCREENWIDTH; i++)
+    {
+        if (i < 32)
+            amfadex[i + 1] = 7 - (i >> 2);
+        else if (i > (finit_width - 32))
+            amfadex[i + 1] = 7 - ((finit_width - i) >> 2);
+        else
+            amfadex[i + 1] = 0;
+    }
+    for (i = 0; i <= SCREENHEIGHT; i++)
+    {
+        if (i < 32)
+            amfadey[i] = 7 - (i >> 2);
+        else if (i > (finit_height - 32))
+            amfadey[i] = 7 - ((finit_height - i) >> 2);
+        else
+            amfadey[i] = 0;
+    }
+}
+
 static boolean stopped = true;
 
 void AM_Stop(void)
@@ -478,6 +521,7 @@ void AM_Start(void)
     }
     AM_initVariables();
     AM_loadPics();
+    AM_initFade();
 }
 
 // set the window scale to the maximum size
@@ -838,13 +882,14 @@ void AM_clearFB(int color)
 // faster reject and precalculated slopes.  If I need the speed, will
 // hash algorithm to the common cases.
 
+enum
+{ LEFT = 1, RIGHT = 2, BOTTOM = 4, TOP = 8 };
+
+static boolean AM_clipFline(fline_t * fl);
+
 boolean AM_clipMline(mline_t * ml, fline_t * fl)
 {
-    enum
-    { LEFT = 1, RIGHT = 2, BOTTOM = 4, TOP = 8 };
-    int outcode1 = 0, outcode2 = 0, outside;
-    fpoint_t tmp = { 0, 0 };
-    int dx, dy;
+    int outcode1 = 0, outcode2 = 0;
 
 #define DOOUTCODE(oc, mx, my) \
   (oc) = 0; \
@@ -881,6 +926,18 @@ boolean AM_clipMline(mline_t * ml, fline_t * fl)
     fl->a.y = CYMTOF(ml->a.y);
     fl->b.x = CXMTOF(ml->b.x);
     fl->b.y = CYMTOF(ml->b.y);
+
+    return AM_clipFline(fl);
+}
+
+// Clips a line already in frame-buffer coordinates to the window
+
+static boolean AM_clipFline(fline_t * fl)
+{
+    int outcode1, outcode2, outside;
+    fpoint_t tmp = { 0, 0 };
+    int dx, dy;
+
     DOOUTCODE(outcode1, fl->a.x, fl->a.y);
     DOOUTCODE(outcode2, fl->b.x, fl->b.y);
     if (outcode1 & outcode2)
@@ -1036,23 +1093,11 @@ void AM_drawFline(fline_t * fl, int color)
  * IntensityBits = log base 2 of NumLevels; the # of bits used to describe
  *          the intensity of the drawing color. 2**IntensityBits==NumLevels
  */
-void PUTDOT(short xx, short yy, byte * cc, byte * cm)
+static inline void PUTDOT(short xx, short yy, byte * cc, byte * cm)
 {
-    static int oldyy;
-    static int oldyyshifted;
     byte *oldcc = cc;
 
-    if (xx < 32)
-        cc += 7 - (xx >> 2);
-    else if (xx > (finit_width - 32))
-        cc += 7 - ((finit_width - xx) >> 2);
-//      if(cc==oldcc) //make sure that we don't double fade the corners.
-//      {
-    if (yy < 32)
-        cc += 7 - (yy >> 2);
-    else if (yy > (finit_height - 32))
-        cc += 7 - ((finit_height - yy) >> 2);
-//      }
+    cc += amfadex[xx + 1] + amfadey[yy];
     if (cc > cm && cm != NULL)
     {
         cc = cm;
@@ -1061,23 +1106,7 @@ void PUTDOT(short xx, short yy, byte * cc, byte * cm)
     {
         cc = oldcc + 6;
     }
-    if (yy == oldyy + 1)
-    {
-        oldyy++;
-        oldyyshifted += 320;
-    }
-    else if (yy == oldyy - 1)
-    {
-        oldyy--;
-        oldyyshifted -= 320;
-    }
-    else if (yy != oldyy)
-    {
-        oldyy = yy;
-        oldyyshifted = yy * 320;
-    }
-    fb[oldyyshifted + xx] = *(cc);
-//      fb[(yy)*f_w+(xx)]=*(cc);
+    fb[yy * f_w + xx] = *(cc);
 }
 
 void DrawWuLine(int X0, int Y0, int X1, int Y1, byte * BaseColor,
@@ -1265,81 +1294,183 @@ void AM_drawGrid(int color)
     }
 }
 
-void AM_drawWalls(void)
+// Transforms a map vertex to frame-buffer coordinates, reusing the
+// result until the window moves or zooms
+
+static void AM_transformVertex(vertex_t * v, fpoint_t * f)
 {
-    int i;
-    static mline_t l;
+    amvertex_t *av = &amvertexes[v - vertexes];
 
-    for (i = 0; i < numlines; i++)
+    if (av->stamp != amviewstamp)
     {
-        l.a.x = lines[i].v1->x;
-        l.a.y = lines[i].v1->y;
-        l.b.x = lines[i].v2->x;
-        l.b.y = lines[i].v2->y;
-        if (cheating || (lines[i].flags & ML_MAPPED))
+        av->x = CXMTOF(v->x);
+        av->y = CYMTOF(v->y);
+        av->stamp = amviewstamp;
+    }
+    f->x = av->x;
+    f->y = av->y;
+}
+
+static void AM_drawLine(line_t * line, int color)
+{
+    fline_t fl;
+
+    // trivial rejects, as in AM_clipMline
+    if (line->bbox[BOXBOTTOM] > m_y2 || line->bbox[BOXTOP] < m_y
+     || line->bbox[BOXLEFT] > m_x2 || line->bbox[BOXRIGHT] < m_x)
+        return;
+
+    AM_transformVertex(line->v1, &fl.a);
+    AM_transformVertex(line->v2, &fl.b);
+    if (AM_clipFline(&fl))
+        AM_drawFline(&fl, color);
+}
+
+static void AM_drawWall(line_t * line)
+{
+    if (cheating || (line->flags & ML_MAPPED))
+    {
+        if ((line->flags & LINE_NEVERSEE) && !cheating)
+            return;
+        if (!line->backsector)
         {
-            if ((lines[i].flags & LINE_NEVERSEE) && !cheating)
-                continue;
-            if (!lines[i].backsector)
+            AM_drawLine(line, WALLCOLORS + lightlev);
+        }
+        else
+        {
+            if (line->special == 39)
+            {               // teleporters
+                AM_drawLine(line, WALLCOLORS + WALLRANGE / 2);
+            }
+            else if (line->flags & ML_SECRET)    // secret door
             {
-                AM_drawMline(&l, WALLCOLORS + lightlev);
+                if (cheating)
+                    AM_drawLine(line, 0);
+                else
+                    AM_drawLine(line, WALLCOLORS + lightlev);
             }
-            else
+            else if (line->special > 25 && line->special < 35)
             {
-                if (lines[i].special == 39)
-                {               // teleporters
-                    AM_drawMline(&l, WALLCOLORS + WALLRANGE / 2);
-                }
-                else if (lines[i].flags & ML_SECRET)    // secret door
-                {
-                    if (cheating)
-                        AM_drawMline(&l, 0);
-                    else
-                        AM_drawMline(&l, WALLCOLORS + lightlev);
-                }
-                else if (lines[i].special > 25 && lines[i].special < 35)
-                {
-                    switch (lines[i].special)
-                    {
-                        case 26:
-                        case 32:
-                            AM_drawMline(&l, BLUEKEY);
-                            break;
-                        case 27:
-                        case 34:
-                            AM_drawMline(&l, YELLOWKEY);
-                            break;
-                        case 28:
-                        case 33:
-                            AM_drawMline(&l, GREENKEY);
-                            break;
-                        default:
-                            break;
-                    }
-                }
-                else if (lines[i].backsector->floorheight
-                         != lines[i].frontsector->floorheight)
-                {
-                    AM_drawMline(&l, FDWALLCOLORS + lightlev);  // floor level change
-                }
-                else if (lines[i].backsector->ceilingheight
-                         != lines[i].frontsector->ceilingheight)
+                switch (line->special)
                 {
-                    AM_drawMline(&l, CDWALLCOLORS + lightlev);  // ceiling level change
-                }
-                else if (cheating)
-                {
-                    AM_drawMline(&l, TSWALLCOLORS + lightlev);
+                    case 26:
+                    case 32:
+                        AM_drawLine(line, BLUEKEY);
+                        break;
+                    case 27:
+                    case 34:
+                        AM_drawLine(line, YELLOWKEY);
+                        break;
+                    case 28:
+                    case 33:
+                        AM_drawLine(line, GREENKEY);
+                        break;
+                    default:
+                        break;
                 }
             }
+            else if (line->backsector->floorheight
+                     != line->frontsector->floorheight)
+            {
+                AM_drawLine(line, FDWALLCOLORS + lightlev);  // floor level change
+            }
+            else if (line->backsector->ceilingheight
+                     != line->frontsector->ceilingheight)
+            {
+                AM_drawLine(line, CDWALLCOLORS + lightlev);  // ceiling level change
+            }
+            else if (cheating)
+            {
+                AM_drawLine(line, TSWALLCOLORS + lightlev);
+            }
         }
-        else if (plr->powers[pw_allmap])
+    }
+    else if (plr->powers[pw_allmap])
+    {
+        if (!(line->flags & LINE_NEVERSEE))
+            AM_drawLine(line, GRAYS + 3);
+    }
+}
+
+// Marks the lines in the blockmap cells under the window.  Returns false
+// if the window shows most of the map, when it is cheaper to go through
+// every line.
+
+static boolean AM_markVisibleLines(void)
+{
+    int bx1, bx2, by1, by2, bx, by;
+    short *list;
+
+    memset(amvisiblelines, 0,
+           ((numlines + 31) >> 5) * sizeof(*amvisiblelines));
+
+    bx1 = (m_x - bmaporgx) >> MAPBLOCKSHIFT;
+    bx2 = (m_x2 - bmaporgx) >> MAPBLOCKSHIFT;
+    by1 = (m_y - bmaporgy) >> MAPBLOCKSHIFT;
+    by2 = (m_y2 - bmaporgy) >> MAPBLOCKSHIFT;
+    if (bx1 < 0)
+        bx1 = 0;
+    if (by1 < 0)
+        by1 = 0;
+    if (bx2 >= bmapwidth)
+        bx2 = bmapwidth - 1;
+    if (by2 >= bmapheight)
+        by2 = bmapheight - 1;
+    if (bx1 > bx2 || by1 > by2)
+        return true;            // off the map
+    if ((bx2 - bx1 + 1) * (by2 - by1 + 1) * 2 > bmapwidth * bmapheight)
+        return false;
+
+    for (by = by1; by <= by2; by++)
+    {
+        for (bx = bx1; bx <= bx2; bx++)
         {
-            if (!(lines[i].flags & LINE_NEVERSEE))
-                AM_drawMline(&l, GRAYS + 3);
+            list = blockmaplump + blockmap[by * bmapwidth + bx];
+            for (; *list != -1; list++)
+                amvisiblelines[*list >> 5] |= 1u << (*list & 31);
         }
     }
+    return true;
+}
+
+void AM_drawWalls(void)
+{
+    int i;
+    unsigned int bits;
 
+    if (amvertexes == NULL)
+    {
+        amvertexes = Z_Malloc(numvertexes * sizeof(*amvertexes), PU_LEVEL,
+                              &amvertexes);
+        memset(amvertexes, 0, numvertexes * sizeof(*amvertexes));
+    }
+    if (amvisiblelines == NULL)
+    {
+        amvisiblelines = Z_Malloc(((numlines + 31) >> 5)
+                                  * sizeof(*amvisiblelines), PU_LEVEL,
+                                  &amvisiblelines);
+    }
+    if (m_x != amview_x || m_y != amview_y || scale_mtof != amview_scale)
+    {
+        amview_x = m_x;
+        amview_y = m_y;
+        amview_scale = scale_mtof;
+        amviewstamp++;
+    }
+
+    if (!AM_markVisibleLines())
+    {
+        for (i = 0; i < numlines; i++)
+            AM_drawWall(&lines[i]);
+        return;
+    }
+
+    // in line order, as when every line is drawn
+    for (i = 0; i < numlines; i += 32)
+    {
+        for (bits = amvisiblelines[i >> 5]; bits; bits &= bits - 1)
+            AM_drawWall(&lines[i + __builtin_ctz(bits)]);
+    }
 }
 
 void AM_rotate(fixed_t * x, fixed_t * y, angle_t a)
@@ -1531,5 +1662,5 @@ void AM_Drawer(void)
         MN_DrTextA(DEH_String(level_name), 20, 145);
     }
 //  I_Update();
-//  V_MarkRect(f_x, f_y, f_w, f_h);
+    V_MarkRect(f_x, f_y, f_w, f_h);
 }
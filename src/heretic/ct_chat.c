@@ -67,6 +67,7 @@ int msglen[MAXPLAYERS];
 boolean cheated;
 
 static int FontABaseLump;
+static lumphandle_t cursorlump = LUMPHANDLE("FONTA59");
 
 const char *CT_FromPlrText[MAXPLAYERS] = {
     "GREEN:  ",
@@ -363,7 +364,7 @@ void CT_Drawer(void)
                 x += patch->width;
             }
         }
-        V_DrawPatch(x, 10, W_CacheLumpName(DEH_String("FONTA59"), PU_CACHE));
+        V_DrawPatch(x, 10, W_CacheLumpHandle(&cursorlump, PU_CACHE));
         BorderTopRefresh = true;
         UpdateState |= I_MESSAGES;
     }
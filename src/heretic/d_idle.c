@@ -0,0 +1,149 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Background jobs run while waiting for the next tic.  Each call to
+//	a job does one small step; a step is only started if the slowest
+//	step that job has taken so far still fits before the deadline, so
+//	the next tic is never held up by more than a misjudged step.
+//
+
+#include <stdio.h>
+
+#include "d_idle.h"
+#include "i_system.h"
+#include "i_timer.h"
+
+#define MAXIDLEJOBS 8
+
+// Time kept back from each deadline for the tic itself
+
+#define IDLE_MARGIN_MS 1
+
+typedef struct
+{
+    const char *name;
+    idlejob_t job;
+    int worstms;                // slowest step so far
+    int steps;
+} idleslot_t;
+
+static idleslot_t idlejobs[MAXIDLEJOBS];
+static int numidlejobs;
+static int nextidlejob;
+
+static idleslot_t *FindIdleJob(idlejob_t job)
+{
+    int i;
+
+    for (i = 0; i < numidlejobs; i++)
+    {
+        if (idlejobs[i].job == job)
+        {
+            return &idlejobs[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void RemoveIdleJob(int i)
+{
+#ifdef IDLE_JOB_LOG
+    printf("D_RunIdleJobs: %s done in %d steps, worst %d ms\n",
+           idlejobs[i].name, idlejobs[i].steps, idlejobs[i].worstms);
+#endif
+
+    --numidlejobs;
+    idlejobs[i] = idlejobs[numidlejobs];
+    if (nextidlejob >= numidlejobs)
+    {
+        nextidlejob = 0;
+    }
+}
+
+void D_StartIdleJob(const char *name, idlejob_t job)
+{
+    idleslot_t *slot;
+
+    slot = FindIdleJob(job);
+    if (slot == NULL)
+    {
+        if (numidlejobs == MAXIDLEJOBS)
+        {
+            I_Error("D_StartIdleJob: too many jobs (%s)", name);
+        }
+        slot = &idlejobs[numidlejobs++];
+    }
+
+    slot->name = name;
+    slot->job = job;
+    slot->worstms = 0;
+    slot->steps = 0;
+}
+
+void D_StopIdleJob(idlejob_t job)
+{
+    idleslot_t *slot;
+
+    slot = FindIdleJob(job);
+    if (slot != NULL)
+    {
+        RemoveIdleJob(slot - idlejobs);
+    }
+}
+
+boolean D_RunIdleJobs(int deadline)
+{
+    idleslot_t *slot;
+    boolean ran;
+    int skipped;
+    int start;
+    int took;
+
+    ran = false;
+    skipped = 0;
+
+    // Round robin, so that one long job doesn't starve the others.
+    // Stop once every job has been passed over for lack of time.
+
+    while (numidlejobs > 0 && skipped < numidlejobs)
+    {
+        slot = &idlejobs[nextidlejob];
+        start = I_GetTimeMS();
+
+        if (start + slot->worstms + IDLE_MARGIN_MS >= deadline)
+        {
+            ++skipped;
+            nextidlejob = (nextidlejob + 1) % numidlejobs;
+            continue;
+        }
+
+        ran = true;
+        skipped = 0;
+        ++slot->steps;
+
+        if (!slot->job())
+        {
+            RemoveIdleJob(slot - idlejobs);
+            continue;
+        }
+
+        took = I_GetTimeMS() - start;
+        if (took > slot->worstms)
+        {
+            slot->worstms = took;
+        }
+        nextidlejob = (nextidlejob + 1) % numidlejobs;
+    }
+
+    return ran;
+}
@@ -0,0 +1,39 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Background jobs run while waiting for the next tic.
+//
+
+#ifndef __D_IDLE__
+#define __D_IDLE__
+
+#include "doomtype.h"
+
+// Does one small piece of work.  Returns false once there is nothing
+// left to do, which removes the job.
+
+typedef boolean (*idlejob_t)(void);
+
+// Adds a job, or restarts it if it is already queued.
+
+void D_StartIdleJob(const char *name, idlejob_t job);
+
+// Removes a job before it has finished.
+
+void D_StopIdleJob(idlejob_t job);
+
+// Runs queued jobs in turn until the time (as I_GetTimeMS) is close
+// to deadline.  Returns false if there was nothing to run.
+
+boolean D_RunIdleJobs(int deadline);
+
+#endif
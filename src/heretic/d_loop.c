@@ -20,6 +20,7 @@
 #include <string.h>
 
 #include "d_event.h"
+#include "d_idle.h"
 #include "d_loop.h"
 #include "d_ticcmd.h"
 
@@ -80,6 +81,11 @@ int gametic;
 
 boolean singletics = false;
 
+// When set, TryRunTics() returns instead of waiting if no tic is due,
+// so that another frame can be drawn in the meantime.
+
+boolean uncappedtics = false;
+
 // Index of the local player.
 
 static int localplayer;
@@ -137,6 +143,22 @@ static int GetAdjustedTime(void)
     return (time_ms * TICRATE) / 1000;
 }
 
+// Time (as I_GetTimeMS) at which GetAdjustedTime reaches the next tic
+
+static int NextTicTime(void)
+{
+    int time_ms;
+
+    time_ms = ((GetAdjustedTime() + 1) * 1000 + TICRATE - 1) / TICRATE;
+
+    if (new_sync)
+    {
+        time_ms -= (offsetms / FRACUNIT);
+    }
+
+    return time_ms;
+}
+
 static boolean BuildNewTic(void)
 {
     int	gameticdiv;
@@ -729,6 +751,16 @@ void TryRunTics (void)
         }
     }
 
+    // No tic due yet: draw another frame instead of waiting for one.
+    // Background jobs get the time up to the next tic first, so frames
+    // come at the tic rate only while there is work queued.
+
+    if (uncappedtics && availabletics < 1 && PlayersInGame())
+    {
+        D_RunIdleJobs(NextTicTime());
+        return;
+    }
+
     if (counts < 1)
 	counts = 1;
 
@@ -768,7 +800,12 @@ void TryRunTics (void)
                 return;
             }
 
-            I_Sleep(1);
+            // Spend the wait on background work if there is any
+
+            if (!D_RunIdleJobs(NextTicTime()))
+            {
+                I_Sleep(1);
+            }
         }
     }
 
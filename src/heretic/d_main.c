@@ -81,6 +81,21 @@ FILE *debugfile;
 
 static int show_endoom = 1;
 
+// If non-zero, levels are drawn as often as possible between tics, with
+// positions interpolated; uncapped_vsync paces the frames to the display.
+#ifndef UNCAPPED_FRAMERATE
+#define UNCAPPED_FRAMERATE 0
+#endif
+static int uncapped_framerate = UNCAPPED_FRAMERATE;
+static int uncapped_vsync = 1;
+
+// Per-frame lumps, resolved once instead of by name every frame
+static lumphandle_t titlepage = LUMPHANDLE("TITLE");
+static lumphandle_t creditpage = LUMPHANDLE("CREDIT");
+static lumphandle_t orderpage = LUMPHANDLE("ORDER");
+static lumphandle_t advisorlump = LUMPHANDLE("ADVISOR");
+static lumphandle_t pausedlump = LUMPHANDLE("PAUSED");
+
 void D_ConnectNetGame(void);
 void D_CheckNetGame(void);
 void D_PageDrawer(void);
@@ -131,6 +146,48 @@ void DrawMessage(void)
     MN_DrTextA(player->message, 160 - MN_TextAWidth(player->message) / 2, 1);
 }
 
+//---------------------------------------------------------------------------
+//
+// FUNC D_Uncapped
+//
+// True if frames should be drawn between tics.
+//
+//---------------------------------------------------------------------------
+
+static boolean D_Uncapped(void)
+{
+    return uncapped_framerate && gamestate == GS_LEVEL && gametic
+        && !paused && !automapactive && !singletics;
+}
+
+//---------------------------------------------------------------------------
+//
+// PROC D_SetupInterpolation
+//
+// Finds how far the frame is between the last tic and the next one.
+//
+//---------------------------------------------------------------------------
+
+static void D_SetupInterpolation(void)
+{
+    int ms;
+
+    interpolateframe = uncappedtics;
+    if (!interpolateframe)
+    {
+        return;
+    }
+    ms = I_GetTimeMS() - oldpositionstime;
+    if (ms < 0 || ms >= 1000 / TICRATE)
+    {
+        fractionaltic = FRACUNIT;
+    }
+    else
+    {
+        fractionaltic = ms * TICRATE * FRACUNIT / 1000;
+    }
+}
+
 //---------------------------------------------------------------------------
 //
 // PROC D_Display
@@ -159,7 +216,13 @@ void D_Display(void)
             if (automapactive)
                 AM_Drawer();
             else
+            {
+                viewanglelatch = G_LateLatchTurn();
+                D_SetupInterpolation();
                 R_RenderPlayerView(&players[displayplayer]);
+                V_MarkRect(viewwindowx, viewwindowy, scaledviewwidth,
+                           viewheight);
+            }
             CT_Drawer();
             UpdateState |= I_FULLVIEW;
             SB_Drawer();
@@ -184,12 +247,12 @@ void D_Display(void)
     {
         if (!netgame)
         {
-            V_DrawPatch(160, viewwindowy + 5, W_CacheLumpName(DEH_String("PAUSED"),
-                                                              PU_CACHE));
+            V_DrawPatch(160, viewwindowy + 5,
+                        W_CacheLumpHandle(&pausedlump, PU_CACHE));
         }
         else
         {
-            V_DrawPatch(160, 70, W_CacheLumpName(DEH_String("PAUSED"), PU_CACHE));
+            V_DrawPatch(160, 70, W_CacheLumpHandle(&pausedlump, PU_CACHE));
         }
     }
     // Handle player messages
@@ -201,6 +264,11 @@ void D_Display(void)
     // Send out any new accumulation
     NetUpdate();
 
+    if (uncappedtics && uncapped_vsync)
+    {
+        I_WaitVBL(1);
+    }
+
     // Flush buffered stuff to screen
     I_FinishUpdate();
 }
@@ -253,7 +321,8 @@ void doomgeneric_Tick(void)
     I_StartFrame();
 
     // Process one or more tics
-    // Will run at least one tic
+    // Will run at least one tic, unless frames are drawn between tics
+    uncappedtics = D_Uncapped();
     TryRunTics();
 
     // Move positional sounds
@@ -271,7 +340,7 @@ void doomgeneric_Tick(void)
 
 static int demosequence;
 static int pagetic;
-static const char *pagename;
+static lumphandle_t *page;
 
 
 /*
@@ -301,12 +370,25 @@ void D_PageTicker(void)
 
 void D_PageDrawer(void)
 {
-    V_DrawRawScreen(W_CacheLumpName(pagename, PU_CACHE));
+    static lumphandle_t *drawnpage;
+    static int drawnsequence;
+    static unsigned int drawnmarks;
+
+    // The page is still on screen if nothing has been drawn since
+    if (page == drawnpage && demosequence == drawnsequence
+     && V_MarkCount() == drawnmarks)
+    {
+        return;
+    }
+
+    V_DrawRawScreen(W_CacheLumpHandle(page, PU_CACHE));
     if (demosequence == 1)
     {
-        V_DrawPatch(4, 160, W_CacheLumpName(DEH_String("ADVISOR"), PU_CACHE));
+        V_DrawPatch(4, 160, W_CacheLumpHandle(&advisorlump, PU_CACHE));
     }
-    UpdateState |= I_FULLSCRN;
+    drawnpage = page;
+    drawnsequence = demosequence;
+    drawnmarks = V_MarkCount();
 }
 
 /*
@@ -336,13 +418,13 @@ void D_DoAdvanceDemo(void)
         case 0:
             pagetic = 210;
             gamestate = GS_DEMOSCREEN;
-            pagename = DEH_String("TITLE");
+            page = &titlepage;
             // S_StartSong(mus_titl, false);
             break;
         case 1:
             pagetic = 140;
             gamestate = GS_DEMOSCREEN;
-            pagename = DEH_String("TITLE");
+            page = &titlepage;
             break;
         case 2:
             BorderNeedRefresh = true;
@@ -352,7 +434,7 @@ void D_DoAdvanceDemo(void)
         case 3:
             pagetic = 200;
             gamestate = GS_DEMOSCREEN;
-            pagename = DEH_String("CREDIT");
+            page = &creditpage;
             break;
         case 4:
             BorderNeedRefresh = true;
@@ -364,11 +446,11 @@ void D_DoAdvanceDemo(void)
             gamestate = GS_DEMOSCREEN;
             if (gamemode == shareware)
             {
-                pagename = DEH_String("ORDER");
+                page = &orderpage;
             }
             else
             {
-                pagename = DEH_String("CREDIT");
+                page = &creditpage;
             }
             break;
         case 6:
@@ -702,6 +784,9 @@ void D_BindVariables(void)
     M_BindIntVariable("snd_channels",           &snd_Channels);
     M_BindIntVariable("vanilla_savegame_limit", &vanilla_savegame_limit);
     M_BindIntVariable("vanilla_demo_limit",     &vanilla_demo_limit);
+    M_BindIntVariable("vanilla_thinker_order",  &vanilla_thinker_order);
+    M_BindIntVariable("uncapped_framerate",     &uncapped_framerate);
+    M_BindIntVariable("uncapped_vsync",         &uncapped_vsync);
     M_BindIntVariable("show_endoom",            &show_endoom);
     M_BindIntVariable("graphical_startup",      &graphical_startup);
 
@@ -137,6 +137,7 @@ typedef struct thinker_s
 {
     struct thinker_s *prev, *next;
     think_t function;
+    struct thinker_s *runprev, *runnext;    // run list, see P_RunThinkers
 } thinker_t;
 
 typedef union
@@ -190,6 +191,10 @@ typedef struct mobj_s
     int lastlook;               // player number last looked for
 
     mapthing_t spawnpoint;      // for nightmare respawn
+
+// where the tic started, for interpolated frames (R_SetupFrame)
+    fixed_t oldx, oldy, oldz;
+    angle_t oldangle;
 } mobj_t;
 
 // each sector has a degenmobj_t in it's center for sound origin purposes
@@ -426,6 +431,7 @@ typedef struct player_s
     ticcmd_t cmd;
 
     fixed_t viewz;              // focal origin above r.z
+    fixed_t oldviewz;           // viewz at the start of the tic
     fixed_t viewheight;         // base height above floor for viewz
     fixed_t deltaviewheight;    // squat speed
     fixed_t bob;                // bounded/scaled total momentum
@@ -526,6 +532,9 @@ extern int consoleplayer;       // player taking events and displaying
 extern int displayplayer;
 
 extern int viewangleoffset;     // ANG90 = left side, ANG270 = right
+extern angle_t viewanglelatch;  // late-latched mouse turn, render only
+extern boolean interpolateframe; // draw between the old and new tic
+extern fixed_t fractionaltic;   // how far into the tic, FRACUNIT = all
 
 extern player_t players[MAXPLAYERS];
 
@@ -580,6 +589,7 @@ extern int testcontrols_mousespeed;
 
 extern int vanilla_savegame_limit;
 extern int vanilla_demo_limit;
+extern int vanilla_thinker_order;
 
 /*
 ===============================================================================
@@ -709,6 +719,7 @@ void D_ProcessEvents(void);
 void G_WorldDone(void);
 
 void G_BuildTiccmd(ticcmd_t *cmd, int maketic);
+angle_t G_LateLatchTurn(void);
 
 void G_Ticker(void);
 boolean G_Responder(event_t * ev);
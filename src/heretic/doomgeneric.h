@@ -40,6 +40,10 @@ void DG_DrawFrame();
 void DG_SleepMs(uint32_t ms);
 uint32_t DG_GetTicksMs();
 int DG_GetKey(int* pressed, unsigned char* key);
+int DG_LatchMouse(void);
+void DG_GetInputLatency(uint32_t *last_us, uint32_t *avg_us, uint32_t *max_us);
+void DG_GetXipCacheStats(uint32_t *hit_permille, uint32_t *frame_us);
+void DG_WaitVBlank(void);
 void DG_SetWindowTitle(const char * title);
 
 #ifdef __cplusplus
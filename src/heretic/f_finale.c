@@ -175,7 +175,7 @@ void F_TextWrite(void)
         }
     }
 
-//      V_MarkRect (0, 0, SCREENWIDTH, SCREENHEIGHT);
+    V_MarkRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
 
 //
 // draw some of the text onto the screen
@@ -262,6 +262,7 @@ void F_DemonScroll(void)
     }
     p1 = W_CacheLumpName(DEH_String("FINAL1"), PU_LEVEL);
     p2 = W_CacheLumpName(DEH_String("FINAL2"), PU_LEVEL);
+    V_MarkRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
     if (finalecount < 70)
     {
         memcpy(I_VideoBuffer, p1, SCREENHEIGHT * SCREENWIDTH);
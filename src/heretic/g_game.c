@@ -783,6 +783,47 @@ void G_BuildTiccmd(ticcmd_t *cmd, int maketic)
 }
 
 
+/*
+==============
+=
+= G_LateLatchTurn
+=
+= Returns the turn the next ticcmd will apply for mouse motion that has
+= arrived since the last one was built, so the view can be drawn with it
+= a tic early.  Only the render uses this; ticcmds are built as usual.
+=
+==============
+*/
+
+angle_t G_LateLatchTurn(void)
+{
+    player_t *player;
+    int turn;
+
+    player = &players[consoleplayer];
+    if (!mouse_late_latch || gamestate != GS_LEVEL || paused || MenuActive
+        || demoplayback || player->playerstate != PST_LIVE
+        || player->mo == NULL || player->mo->reactiontime)
+    {
+        return 0;
+    }
+
+    // Mouse motion moves sideways instead of turning while strafing
+
+    if (gamekeydown[key_strafe] || mousebuttons[mousebstrafe]
+        || joybuttons[joybstrafe])
+    {
+        return 0;
+    }
+
+    // Motion already posted waits in mousex; latched motion is posted
+    // with the next tick and added to it (see G_Responder).
+
+    turn = mousex + I_LatchMouse() * (mouseSensitivity + 5) / 10;
+
+    return ((angle_t) (short) (-turn * 0x8)) << 16;
+}
+
 /*
 ==============
 =
@@ -1085,9 +1126,10 @@ boolean G_Responder(event_t * ev)
             return (false);     // always let key up events filter down
 
         case ev_mouse:
+            // Added up, as more than one event may come before a ticcmd
             SetMouseButtons(ev->data1);
-            mousex = ev->data2 * (mouseSensitivity + 5) / 10;
-            mousey = ev->data3 * (mouseSensitivity + 5) / 10;
+            mousex += ev->data2 * (mouseSensitivity + 5) / 10;
+            mousey += ev->data3 * (mouseSensitivity + 5) / 10;
             return (true);      // eat events
 
         case ev_joystick:
@@ -1714,6 +1756,7 @@ void G_DoLoadGame(void)
     P_UnArchiveWorld();
     P_UnArchiveThinkers();
     P_UnArchiveSpecials();
+    P_StoreOldPositions();
 
     if (SV_ReadByte() != SAVE_GAME_TERMINATOR)
     {                           // Missing savegame termination marker
@@ -43,6 +43,11 @@
 
 int vanilla_keyboard_mapping = 1;
 
+// If non-zero, mouse motion is sampled again just before the view is
+// rendered and shown a tic early (see G_LateLatchTurn).
+
+int mouse_late_latch = 0;
+
 // Is the shift key currently down?
 
 static int shiftdown = 0;
@@ -337,6 +342,20 @@ void I_GetEvent(void)
                 */
 }
 
+//
+// I_LatchMouse
+//
+// Re-poll the mouse and return the horizontal motion that has not yet
+// been posted as an ev_mouse event, in ev_mouse data2 units.  The
+// motion stays queued in the driver and is delivered by the next
+// I_GetEvent as usual.
+//
+
+int I_LatchMouse(void)
+{
+    return DG_LatchMouse();
+}
+
 void I_InitInput(void)
 {
 }
@@ -344,4 +363,7 @@ void I_InitInput(void)
 
 void I_StartTextInput(int x, int y, int w, int h) {}
 void I_StopTextInput(void) {}
-void I_BindInputVariables(void) {}
+void I_BindInputVariables(void)
+{
+    M_BindIntVariable("mouse_late_latch", &mouse_late_latch);
+}
@@ -30,9 +30,11 @@ typedef struct { int dummy; } SDL_Event;
 
 extern float mouse_acceleration;
 extern int mouse_threshold;
+extern int mouse_late_latch;
 
 void I_BindInputVariables(void);
 void I_ReadMouse(void);
+int I_LatchMouse(void);
 
 // I_StartTextInput begins text input, activating the on-screen keyboard
 // (if one is used). The caller indicates that any entered text will be
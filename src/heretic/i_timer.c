@@ -93,7 +93,10 @@ void I_Sleep(int ms)
 
 void I_WaitVBL(int count)
 {
-    //I_Sleep((count * 1000) / 70);
+    while (count-- > 0)
+    {
+        DG_WaitVBlank();
+    }
 }
 
 
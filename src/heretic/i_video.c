@@ -34,6 +34,7 @@ rcsid[] = "$Id: i_x.c,v 1.6 1997/02/03 22:45:10 b1 Exp $";
 #include "i_system.h"
 #include "z_zone.h"
 #include "doomstat.h"
+#include "r_local.h"
 
 #include "tables.h"
 #include "doomkeys.h"
@@ -291,6 +292,7 @@ void I_InitGraphics (void)
 	I_VideoBuffer = (byte*)Z_Malloc (SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);  // For DOOM to draw on
 	// Clear the entire buffer to prevent garbage in unused areas
 	memset(I_VideoBuffer, 0, SCREENWIDTH * SCREENHEIGHT);
+	V_AddDirtyRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
 
 	screenvisible = true;
 
@@ -345,6 +347,33 @@ static void fill_output_black(unsigned char *dest, int num_lines)
     }
 }
 
+//
+// I_MarkUpdateState
+// Turn the vanilla UpdateState bits into dirty rectangles.  Anything drawn
+// through v_video.c is already marked; these cover the rest.
+//
+
+static void I_MarkUpdateState(void)
+{
+    if (UpdateState & I_FULLSCRN)
+    {
+        V_AddDirtyRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
+    }
+    if (UpdateState & I_FULLVIEW)
+    {
+        V_AddDirtyRect(viewwindowx, viewwindowy, scaledviewwidth, viewheight);
+    }
+    if (UpdateState & I_STATBAR)
+    {
+        V_AddDirtyRect(0, SCREENHEIGHT - SBARHEIGHT, SCREENWIDTH, SBARHEIGHT);
+    }
+    if (UpdateState & I_MESSAGES)
+    {
+        V_AddDirtyRect(0, 0, SCREENWIDTH, 32);
+    }
+    UpdateState = I_NOUPDATE;
+}
+
 //
 // I_FinishUpdate
 //
@@ -358,8 +387,9 @@ void I_FinishUpdate (void)
     }
     */
 
-    int y;
-    int x_offset, y_offset, x_offset_end;
+    int y, lines;
+    int x_offset, y_offset, x_offset_end, line_pitch;
+    int bytes_pp;
     unsigned char *line_in, *line_out;
 
     /* Offsets in case FB is bigger than DOOM */
@@ -370,6 +400,16 @@ void I_FinishUpdate (void)
     x_offset     = (((s_Fb.xres - (SCREENWIDTH  * fb_scaling)) * s_Fb.bits_per_pixel/8)) / 2; // XXX: siglent FB hack: /4 instead of /2, since it seems to handle the resolution in a funny way
     //x_offset     = 0;
     x_offset_end = ((s_Fb.xres - (SCREENWIDTH  * fb_scaling)) * s_Fb.bits_per_pixel/8) - x_offset;
+    bytes_pp     = s_Fb.bits_per_pixel / 8;
+    line_pitch   = x_offset + (SCREENWIDTH * fb_scaling * bytes_pp) + x_offset_end;
+
+    I_MarkUpdateState();
+
+    // The 200-line and 240-line layouts put rows at different places,
+    // so switching between them needs everything copied again.
+    if ((gamestate == GS_LEVEL) != (prev_gamestate == GS_LEVEL)) {
+        V_AddDirtyRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
+    }
 
     /* DRAW SCREEN */
     line_in  = (unsigned char *) I_VideoBuffer;
@@ -387,38 +427,52 @@ void I_FinishUpdate (void)
         
         // Offset output by 20 lines to center the content
         line_out += (20 * SCREENWIDTH * s_Fb.bits_per_pixel / 8);
-        y = 200;  // Only copy Doom's 200 rendered lines
+        lines = 200;  // Only copy Doom's 200 rendered lines
     } else {
-        y = SCREENHEIGHT;  // Copy all 240 lines during gameplay (includes status bar)
+        lines = SCREENHEIGHT;  // Copy all 240 lines during gameplay (includes status bar)
     }
     prev_gamestate = gamestate;
 
-    while (y--)
+    // Nothing drawn since the last frame: the output already matches.
+    if (!V_ScreenDirty()) {
+        DG_DrawFrame();
+        return;
+    }
+
+    // Copy only the dirty span of each dirty row
+    for (y = 0; y < lines; y++, line_in += SCREENWIDTH, line_out += line_pitch * fb_scaling)
     {
-        int i;
+        int i, x1, x2;
+        unsigned char *out;
+
+        if (!V_GetDirtySpan(y, &x1, &x2)) {
+            continue;
+        }
+
+        out = line_out;
         for (i = 0; i < fb_scaling; i++) {
-            line_out += x_offset;
+            out += x_offset;
 #ifdef CMAP256
             if (fb_scaling == 1) {
-                memcpy(line_out, line_in, SCREENWIDTH); /* fb_width is bigger than Doom SCREENWIDTH... */
+                memcpy(out + x1, line_in + x1, x2 - x1); /* fb_width is bigger than Doom SCREENWIDTH... */
             } else {
                 int j;
 
-                for (j = 0; j < SCREENWIDTH; j++) {
+                for (j = x1; j < x2; j++) {
                     int k;
                     for (k = 0; k < fb_scaling; k++) {
-                        line_out[j * fb_scaling + k] = line_in[j];
+                        out[j * fb_scaling + k] = line_in[j];
                     }
                 }
             }
 #else
-            //cmap_to_rgb565((void*)line_out, (void*)line_in, SCREENWIDTH);
-            cmap_to_fb((void*)line_out, (void*)line_in, SCREENWIDTH);
+            //cmap_to_rgb565((void*)out, (void*)line_in, SCREENWIDTH);
+            cmap_to_fb((void*)(out + x1 * fb_scaling * bytes_pp), (void*)(line_in + x1), x2 - x1);
 #endif
-            line_out += (SCREENWIDTH * fb_scaling * (s_Fb.bits_per_pixel/8)) + x_offset_end;
+            out += (SCREENWIDTH * fb_scaling * bytes_pp) + x_offset_end;
         }
-        line_in += SCREENWIDTH;
     }
+    V_ClearDirty();
 
 	DG_DrawFrame();
 }
@@ -472,6 +526,11 @@ void I_SetPalette (byte* palette)
 
     palette_changed = true;
 
+#else
+
+    // Pixels are converted on the way out, so all of them change
+    V_AddDirtyRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
+
 #endif  // CMAP256
 }
 
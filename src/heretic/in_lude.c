@@ -92,6 +92,7 @@ static int FontBLump;
 static int FontBLumpBase;
 static int patchFaceOkayBase;
 static int patchFaceDeadBase;
+static lumphandle_t backgroundlump = LUMPHANDLE("FLOOR16");
 
 static signed int totalFrags[MAXPLAYERS];
 static fixed_t dSlideX[MAXPLAYERS];
@@ -581,8 +582,9 @@ void IN_DrawStatBack(void)
     byte *src;
     byte *dest;
 
-    src = W_CacheLumpName(DEH_String("FLOOR16"), PU_CACHE);
+    src = W_CacheLumpHandle(&backgroundlump, PU_CACHE);
     dest = I_VideoBuffer;
+    V_MarkRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
 
     for (y = 0; y < SCREENHEIGHT; y++)
     {
@@ -1122,6 +1122,35 @@ static default_t extra_defaults_list[] =
 
     CONFIG_VARIABLE_INT(vanilla_demo_limit),
 
+    //!
+    // @game heretic
+    //
+    // If non-zero, thinkers always run in the order they were created,
+    // as in Vanilla.  Otherwise they run a kind at a time outside of
+    // demos and netgames.
+    //
+
+    CONFIG_VARIABLE_INT(vanilla_thinker_order),
+
+    //!
+    // @game heretic
+    //
+    // If non-zero, the view is drawn as often as it can be between tics,
+    // with things and moving floors and ceilings interpolated between
+    // tics.  The game itself still runs at 35 tics per second.
+    //
+
+    CONFIG_VARIABLE_INT(uncapped_framerate),
+
+    //!
+    // @game heretic
+    //
+    // If non-zero, uncapped frames wait for the vertical blank, so no
+    // more are drawn than the display shows.
+    //
+
+    CONFIG_VARIABLE_INT(uncapped_vsync),
+
     //!
     // If non-zero, the game behaves like Vanilla Doom, always assuming
     // an American keyboard mapping.  If this has a value of zero, the
@@ -1169,6 +1198,14 @@ static default_t extra_defaults_list[] =
 
     CONFIG_VARIABLE_INT(mouse_threshold),
 
+    //!
+    // If non-zero, mouse turning is sampled again just before each frame
+    // is rendered and applied to the view, so it shows up a tic early.
+    // Only the displayed view is affected; game tics are unchanged.
+    //
+
+    CONFIG_VARIABLE_INT(mouse_late_latch),
+
     //!
     // Mouse button to strafe left.
     //
@@ -2329,6 +2366,7 @@ static void LoadDefaultCollection(default_collection_t *collection)
 {
     FILE *f;
     default_t *def;
+    char line[256];
     char defname[80];
     char strparm[100];
 
@@ -2343,9 +2381,11 @@ static void LoadDefaultCollection(default_collection_t *collection)
         return;
     }
 
-    while (!feof(f))
+    // One setting per line
+
+    while (fgets(line, sizeof(line), f) != NULL)
     {
-        if (fscanf(f, "%79s %99[^\n]\n", defname, strparm) != 2)
+        if (sscanf(line, "%79s %99[^\n]", defname, strparm) != 2)
         {
             // This line doesn't match
 
@@ -135,6 +135,19 @@ boolean messageson;
 static int FontABaseLump;
 static int FontBBaseLump;
 static int SkullBaseLump;
+
+// Lumps drawn every menu frame, resolved once
+static lumphandle_t SelectorLumps[2] = {
+    LUMPHANDLE("M_SLCTR1"), LUMPHANDLE("M_SLCTR2")
+};
+static lumphandle_t TitleLump = LUMPHANDLE("M_HTIC");
+static lumphandle_t FileSlotLump = LUMPHANDLE("M_FSLOT");
+static lumphandle_t SliderLeftLump = LUMPHANDLE("M_SLDLT");
+static lumphandle_t SliderMidLumps[2] = {
+    LUMPHANDLE("M_SLDMD2"), LUMPHANDLE("M_SLDMD1")
+};
+static lumphandle_t SliderRightLump = LUMPHANDLE("M_SLDRT");
+static lumphandle_t SliderKnobLump = LUMPHANDLE("M_SLDKB");
 static Menu_t *CurrentMenu;
 static int CurrentItPos;
 static int MenuEpisode;
@@ -477,7 +490,7 @@ void MN_Drawer(void)
     int y;
     MenuItem_t *item;
     const char *message;
-    const char *selName;
+    lumphandle_t *selLump;
 
     if (MenuActive == false)
     {
@@ -506,12 +519,12 @@ void MN_Drawer(void)
     }
     else
     {
-        UpdateState |= I_FULLSCRN;
         if (InfoType)
         {
             MN_DrawInfo();
             return;
         }
+        UpdateState |= I_FULLSCRN;
         if (screenblocks < 10)
         {
             BorderNeedRefresh = true;
@@ -533,9 +546,9 @@ void MN_Drawer(void)
             item++;
         }
         y = CurrentMenu->y + (CurrentItPos * ITEM_HEIGHT) + SELECTOR_YOFFSET;
-        selName = DEH_String(MenuTime & 16 ? "M_SLCTR1" : "M_SLCTR2");
+        selLump = &SelectorLumps[MenuTime & 16 ? 0 : 1];
         V_DrawPatch(x + SELECTOR_XOFFSET, y,
-                    W_CacheLumpName(selName, PU_CACHE));
+                    W_CacheLumpHandle(selLump, PU_CACHE));
     }
 }
 
@@ -550,7 +563,7 @@ static void DrawMainMenu(void)
     int frame;
 
     frame = (MenuTime / 3) % 18;
-    V_DrawPatch(88, 0, W_CacheLumpName(DEH_String("M_HTIC"), PU_CACHE));
+    V_DrawPatch(88, 0, W_CacheLumpHandle(&TitleLump, PU_CACHE));
     V_DrawPatch(40, 10, W_CacheLumpNum(SkullBaseLump + (17 - frame),
                                        PU_CACHE));
     V_DrawPatch(232, 10, W_CacheLumpNum(SkullBaseLump + frame, PU_CACHE));
@@ -680,7 +693,7 @@ static void DrawFileSlots(Menu_t * menu)
     y = menu->y;
     for (i = 0; i < 6; i++)
     {
-        V_DrawPatch(x, y, W_CacheLumpName(DEH_String("M_FSLOT"), PU_CACHE));
+        V_DrawPatch(x, y, W_CacheLumpHandle(&FileSlotLump, PU_CACHE));
         if (SlotStatus[i])
         {
             MN_DrTextA(SlotText[i], x + 5, y + 5);
@@ -1782,9 +1795,20 @@ void MN_DeactivateMenu(void)
 
 void MN_DrawInfo(void)
 {
+    static int drawninfo;
+    static unsigned int drawnmarks;
+
+    // Still on screen if nothing has been drawn since
+    if (InfoType == drawninfo && V_MarkCount() == drawnmarks)
+    {
+        return;
+    }
+
     I_SetPalette(W_CacheLumpName("PLAYPAL", PU_CACHE));
     V_DrawRawScreen(W_CacheLumpNum(W_GetNumForName("TITLE") + InfoType,
                                    PU_CACHE));
+    drawninfo = InfoType;
+    drawnmarks = V_MarkCount();
 //      V_DrawPatch(0, 0, W_CacheLumpNum(W_GetNumForName("TITLE")+InfoType,
 //              PU_CACHE));
 }
@@ -1818,13 +1842,13 @@ static void DrawSlider(Menu_t * menu, int item, int width, int slot)
 
     x = menu->x + 24;
     y = menu->y + 2 + (item * ITEM_HEIGHT);
-    V_DrawPatch(x - 32, y, W_CacheLumpName(DEH_String("M_SLDLT"), PU_CACHE));
+    V_DrawPatch(x - 32, y, W_CacheLumpHandle(&SliderLeftLump, PU_CACHE));
     for (x2 = x, count = width; count--; x2 += 8)
     {
-        V_DrawPatch(x2, y, W_CacheLumpName(DEH_String(count & 1 ? "M_SLDMD1"
-                                           : "M_SLDMD2"), PU_CACHE));
+        V_DrawPatch(x2, y, W_CacheLumpHandle(&SliderMidLumps[count & 1],
+                                             PU_CACHE));
     }
-    V_DrawPatch(x2, y, W_CacheLumpName(DEH_String("M_SLDRT"), PU_CACHE));
+    V_DrawPatch(x2, y, W_CacheLumpHandle(&SliderRightLump, PU_CACHE));
     V_DrawPatch(x + 4 + slot * 8, y + 7,
-                W_CacheLumpName(DEH_String("M_SLDKB"), PU_CACHE));
+                W_CacheLumpHandle(&SliderKnobLump, PU_CACHE));
 }
@@ -159,7 +159,7 @@ int EV_DoDoor(line_t * line, vldoor_e type, fixed_t speed)
         }
         // Add new door thinker
         retcode = 1;
-        door = Z_Malloc(sizeof(*door), PU_LEVSPEC, 0);
+        door = P_PoolAlloc(PT_DOOR);
         P_AddThinker(&door->thinker);
         sec->specialdata = door;
         door->thinker.function = T_VerticalDoor;
@@ -302,7 +302,7 @@ void EV_VerticalDoor(line_t * line, mobj_t * thing)
     //
     // new door thinker
     //
-    door = Z_Malloc(sizeof(*door), PU_LEVSPEC, 0);
+    door = P_PoolAlloc(PT_DOOR);
     P_AddThinker(&door->thinker);
     sec->specialdata = door;
     door->thinker.function = T_VerticalDoor;
@@ -343,7 +343,7 @@ void P_SpawnDoorCloseIn30(sector_t * sec)
 {
     vldoor_t *door;
 
-    door = Z_Malloc(sizeof(*door), PU_LEVSPEC, 0);
+    door = P_PoolAlloc(PT_DOOR);
     P_AddThinker(&door->thinker);
     sec->specialdata = door;
     sec->special = 0;
@@ -364,7 +364,7 @@ void P_SpawnDoorRaiseIn5Mins(sector_t * sec, int secnum)
 {
     vldoor_t *door;
 
-    door = Z_Malloc(sizeof(*door), PU_LEVSPEC, 0);
+    door = P_PoolAlloc(PT_DOOR);
     P_AddThinker(&door->thinker);
     sec->specialdata = door;
     sec->special = 0;
@@ -40,6 +40,8 @@ result_e T_MovePlane(sector_t * sector, fixed_t speed,
     boolean flag;
     fixed_t lastpos;
 
+    sectorgeneration++;         // earlier sight checks may no longer hold
+
     switch (floorOrCeiling)
     {
         case 0:                // FLOOR
@@ -249,7 +251,7 @@ int EV_DoFloor(line_t * line, floor_e floortype)
         //      new floor thinker
         //
         rtn = 1;
-        floor = Z_Malloc(sizeof(*floor), PU_LEVSPEC, 0);
+        floor = P_PoolAlloc(PT_FLOOR);
         P_AddThinker(&floor->thinker);
         sec->specialdata = floor;
         floor->thinker.function = T_MoveFloor;
@@ -402,7 +404,7 @@ int EV_BuildStairs(line_t * line, fixed_t stepDelta)
         //
         rtn = 1;
         height = sec->floorheight + stepDelta;
-        floor = Z_Malloc(sizeof(*floor), PU_LEVSPEC, 0);
+        floor = P_PoolAlloc(PT_FLOOR);
         P_AddThinker(&floor->thinker);
         sec->specialdata = floor;
         floor->thinker.function = T_MoveFloor;
@@ -442,7 +444,7 @@ int EV_BuildStairs(line_t * line, fixed_t stepDelta)
 
                 sec = tsec;
                 secnum = newsecnum;
-                floor = Z_Malloc(sizeof(*floor), PU_LEVSPEC, 0);
+                floor = P_PoolAlloc(PT_FLOOR);
                 P_AddThinker(&floor->thinker);
                 sec->specialdata = floor;
                 floor->thinker.function = T_MoveFloor;
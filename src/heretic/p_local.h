@@ -79,10 +79,33 @@ typedef enum
 
 extern thinker_t thinkercap;    // both the head and tail of the thinker list
 extern int TimerGame;           // tic countdown for deathmatch
+extern int oldpositionstime;    // when this tic's old positions were kept
 
 void P_InitThinkers(void);
 void P_AddThinker(thinker_t * thinker);
 void P_RemoveThinker(thinker_t * thinker);
+void P_StoreOldPositions(void);
+
+// ***** P_POOL *****
+
+typedef enum
+{
+    PT_MOBJ,
+    PT_CEILING,
+    PT_DOOR,
+    PT_FLOOR,
+    PT_PLAT,
+    PT_LIGHTFLASH,
+    PT_STROBE,
+    PT_GLOW,
+    NUMPOOLTYPES
+} pooltype_t;
+
+void P_InitPools(void);
+void P_ReleasePools(void);
+void *P_PoolAlloc(pooltype_t type);
+void P_PoolFree(void *ptr);
+void P_PoolStats(pooltype_t type, int *inuse, int *highwater, int *slabs);
 
 // ***** P_PSPR *****
 
@@ -231,6 +254,7 @@ void P_SlideMove(mobj_t * mo);
 extern fixed_t topslope, bottomslope;   // slopes to top and bottom of target
 
 boolean P_CheckSight(mobj_t * t1, mobj_t * t2);
+void P_InitSightMatrix(void);
 void P_UseLines(player_t * player);
 
 boolean P_ChangeSector(sector_t * sector, boolean crunch);
@@ -251,6 +275,8 @@ extern int numspechit;
 // ***** P_SETUP *****
 
 extern byte *rejectmatrix;      // for fast sight rejection
+extern byte *sightmatrix;       // rejectmatrix plus unconnected sectors
+extern unsigned int sectorgeneration;   // bumped when a plane moves
 extern short *blockmaplump;     // offsets in blockmap are from here
 extern short *blockmap;
 extern int bmapwidth, bmapheight;       // in mapblocks
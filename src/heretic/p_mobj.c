@@ -650,7 +650,7 @@ void P_NightmareRespawn(mobj_t * mobj)
         z = ONFLOORZ;
     mo = P_SpawnMobj(x, y, z, mobj->type);
     mo->spawnpoint = mobj->spawnpoint;
-    mo->angle = ANG45 * (mthing->angle / 45);
+    mo->angle = mo->oldangle = ANG45 * (mthing->angle / 45);
     if (mthing->options & MTF_AMBUSH)
         mo->flags |= MF_AMBUSH;
 
@@ -859,7 +859,7 @@ mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type)
     mobjinfo_t *info;
     fixed_t space;
 
-    mobj = Z_Malloc(sizeof(*mobj), PU_LEVEL, NULL);
+    mobj = P_PoolAlloc(PT_MOBJ);
     memset(mobj, 0, sizeof(*mobj));
     info = &mobjinfo[type];
     mobj->type = type;
@@ -927,6 +927,10 @@ mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type)
     {
         mobj->flags2 &= ~MF2_FEETARECLIPPED;
     }
+    mobj->oldx = mobj->x;
+    mobj->oldy = mobj->y;
+    mobj->oldz = mobj->z;
+    mobj->oldangle = mobj->angle;
 
     mobj->thinker.function = P_MobjThinker;
     P_AddThinker(&mobj->thinker);
@@ -987,7 +991,7 @@ void P_SpawnPlayer(mapthing_t * mthing)
     if (mthing->type > 1)       // set color translations for player sprites
         mobj->flags |= (mthing->type - 1) << MF_TRANSSHIFT;
 
-    mobj->angle = ANG45 * (mthing->angle / 45);
+    mobj->angle = mobj->oldangle = ANG45 * (mthing->angle / 45);
     mobj->player = p;
     mobj->health = p->health;
     p->mo = mobj;
@@ -1167,7 +1171,7 @@ void P_SpawnMapThing(mapthing_t * mthing)
     {
         totalitems++;
     }
-    mobj->angle = ANG45 * (mthing->angle / 45);
+    mobj->angle = mobj->oldangle = ANG45 * (mthing->angle / 45);
     if (mthing->options & MTF_AMBUSH)
     {
         mobj->flags |= MF_AMBUSH;
@@ -0,0 +1,221 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+
+// P_pool.c
+//
+// Fixed size pools for mobjs and level special thinkers.  Objects are
+// carved out of zone slabs tagged with the level, and freed objects go
+// on a per-type free list instead of back to the zone, so a busy fight
+// doesn't keep walking the zone rover.  Z_FreeTags releases the slabs in
+// bulk when the next level is set up.
+
+#include <stdio.h>
+
+#include "doomdef.h"
+#include "i_system.h"
+#include "p_local.h"
+
+// Every object is preceded by a header naming its pool, so that
+// P_PoolFree can be handed any thinker.  The union keeps the object
+// itself 8-byte aligned.
+
+typedef union poolhdr_u
+{
+    struct pool_s *pool;
+    long long align;
+} poolhdr_t;
+
+typedef struct poolfree_s
+{
+    struct poolfree_s *next;
+} poolfree_t;
+
+typedef union poolslab_u
+{
+    union poolslab_u *next;
+    long long align;
+} poolslab_t;
+
+typedef struct pool_s
+{
+    const char *name;
+    int size;                   // object size, header included
+    int perslab;
+    int tag;
+    poolslab_t *slablist;
+    poolfree_t *freelist;
+    int inuse;
+    int highwater;              // most in use at once on this map
+    int slabs;
+} pool_t;
+
+#define POOLITEMSIZE(type) \
+    ((int) ((sizeof(poolhdr_t) + sizeof(type) + 7) & ~7))
+
+static pool_t pools[NUMPOOLTYPES] = {
+    {"mobj",      POOLITEMSIZE(mobj_t),       64, PU_LEVEL},
+    {"ceiling",   POOLITEMSIZE(ceiling_t),    16, PU_LEVSPEC},
+    {"door",      POOLITEMSIZE(vldoor_t),     16, PU_LEVSPEC},
+    {"floor",     POOLITEMSIZE(floormove_t),  16, PU_LEVSPEC},
+    {"plat",      POOLITEMSIZE(plat_t),       16, PU_LEVSPEC},
+    {"flash",     POOLITEMSIZE(lightflash_t), 16, PU_LEVSPEC},
+    {"strobe",    POOLITEMSIZE(strobe_t),     16, PU_LEVSPEC},
+    {"glow",      POOLITEMSIZE(glow_t),       16, PU_LEVSPEC},
+};
+
+//----------------------------------------------------------------------------
+//
+// PROC P_InitPools
+//
+// Forgets all slabs.  Called after Z_FreeTags has released them.
+//
+//----------------------------------------------------------------------------
+
+void P_InitPools(void)
+{
+    pool_t *pool;
+    int i;
+
+#ifdef THINKER_POOL_LOG
+    for (i = 0; i < NUMPOOLTYPES; i++)
+    {
+        if (pools[i].slabs)
+        {
+            printf("P_InitPools: %s high-water %d in %d slabs\n",
+                   pools[i].name, pools[i].highwater, pools[i].slabs);
+        }
+    }
+#endif
+
+    for (i = 0, pool = pools; i < NUMPOOLTYPES; i++, pool++)
+    {
+        pool->slablist = NULL;
+        pool->freelist = NULL;
+        pool->inuse = 0;
+        pool->highwater = 0;
+        pool->slabs = 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// PROC P_FillSlab
+//
+//----------------------------------------------------------------------------
+
+static void P_FillSlab(pool_t *pool, poolslab_t *slab)
+{
+    byte *items;
+    poolfree_t *item;
+    int i;
+
+    items = (byte *) (slab + 1);
+    for (i = pool->perslab - 1; i >= 0; i--)
+    {
+        item = (poolfree_t *) (items + i * pool->size);
+        item->next = pool->freelist;
+        pool->freelist = item;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// PROC P_ReleasePools
+//
+// Frees every object in every pool at once, keeping the slabs.  Only
+// valid when no thinker is left in the thinker list.
+//
+//----------------------------------------------------------------------------
+
+void P_ReleasePools(void)
+{
+    pool_t *pool;
+    poolslab_t *slab;
+    int i;
+
+    for (i = 0, pool = pools; i < NUMPOOLTYPES; i++, pool++)
+    {
+        pool->freelist = NULL;
+        pool->inuse = 0;
+        for (slab = pool->slablist; slab != NULL; slab = slab->next)
+        {
+            P_FillSlab(pool, slab);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// FUNC P_PoolAlloc
+//
+//----------------------------------------------------------------------------
+
+void *P_PoolAlloc(pooltype_t type)
+{
+    pool_t *pool;
+    poolfree_t *item;
+    poolslab_t *slab;
+
+    pool = &pools[type];
+    if (pool->freelist == NULL)
+    {
+        slab = Z_Malloc(sizeof(*slab) + pool->size * pool->perslab,
+                        pool->tag, NULL);
+        slab->next = pool->slablist;
+        pool->slablist = slab;
+        pool->slabs++;
+        P_FillSlab(pool, slab);
+    }
+
+    item = pool->freelist;
+    pool->freelist = item->next;
+    if (++pool->inuse > pool->highwater)
+    {
+        pool->highwater = pool->inuse;
+    }
+
+    ((poolhdr_t *) item)->pool = pool;
+    return (poolhdr_t *) item + 1;
+}
+
+//----------------------------------------------------------------------------
+//
+// PROC P_PoolFree
+//
+//----------------------------------------------------------------------------
+
+void P_PoolFree(void *ptr)
+{
+    poolhdr_t *hdr;
+    poolfree_t *item;
+    pool_t *pool;
+
+    hdr = (poolhdr_t *) ptr - 1;
+    pool = hdr->pool;
+    item = (poolfree_t *) hdr;
+    item->next = pool->freelist;
+    pool->freelist = item;
+    pool->inuse--;
+}
+
+//----------------------------------------------------------------------------
+//
+// PROC P_PoolStats
+//
+//----------------------------------------------------------------------------
+
+void P_PoolStats(pooltype_t type, int *inuse, int *highwater, int *slabs)
+{
+    *inuse = pools[type].inuse;
+    *highwater = pools[type].highwater;
+    *slabs = pools[type].slabs;
+}
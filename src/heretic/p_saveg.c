@@ -1615,6 +1615,8 @@ void P_UnArchiveWorld(void)
     line_t *li;
     side_t *si;
 
+    sectorgeneration++;
+
 //
 // do sectors
 //
@@ -1711,10 +1713,11 @@ void P_UnArchiveThinkers(void)
         if (currentthinker->function == P_MobjThinker)
             P_RemoveMobj((mobj_t *) currentthinker);
         else
-            Z_Free(currentthinker);
+            P_PoolFree(currentthinker);
         currentthinker = next;
     }
     P_InitThinkers();
+    P_ReleasePools();           // the removed mobjs are still held
 
     // read in saved thinkers
     while (1)
@@ -1726,7 +1729,7 @@ void P_UnArchiveThinkers(void)
                 return;         // end of list
 
             case tc_mobj:
-                mobj = Z_Malloc(sizeof(*mobj), PU_LEVEL, NULL);
+                mobj = P_PoolAlloc(PT_MOBJ);
                 saveg_read_mobj_t(mobj);
                 mobj->target = NULL;
                 P_SetThingPosition(mobj);
@@ -1853,7 +1856,7 @@ void P_UnArchiveSpecials(void)
                 return;         // end of list
 
             case tc_ceiling:
-                ceiling = Z_Malloc(sizeof(*ceiling), PU_LEVEL, NULL);
+                ceiling = P_PoolAlloc(PT_CEILING);
                 saveg_read_ceiling_t(ceiling);
                 ceiling->sector->specialdata = T_MoveCeiling;  // ???
                 ceiling->thinker.function = T_MoveCeiling;
@@ -1862,7 +1865,7 @@ void P_UnArchiveSpecials(void)
                 break;
 
             case tc_door:
-                door = Z_Malloc(sizeof(*door), PU_LEVEL, NULL);
+                door = P_PoolAlloc(PT_DOOR);
                 saveg_read_vldoor_t(door);
                 door->sector->specialdata = door;
                 door->thinker.function = T_VerticalDoor;
@@ -1870,7 +1873,7 @@ void P_UnArchiveSpecials(void)
                 break;
 
             case tc_floor:
-                floor = Z_Malloc(sizeof(*floor), PU_LEVEL, NULL);
+                floor = P_PoolAlloc(PT_FLOOR);
                 saveg_read_floormove_t(floor);
                 floor->sector->specialdata = T_MoveFloor;
                 floor->thinker.function = T_MoveFloor;
@@ -1878,7 +1881,7 @@ void P_UnArchiveSpecials(void)
                 break;
 
             case tc_plat:
-                plat = Z_Malloc(sizeof(*plat), PU_LEVEL, NULL);
+                plat = P_PoolAlloc(PT_PLAT);
                 saveg_read_plat_t(plat);
                 plat->sector->specialdata = T_PlatRaise;
                 // In the original Heretic code this was a conditional "fix"
@@ -1893,21 +1896,21 @@ void P_UnArchiveSpecials(void)
                 break;
 
             case tc_flash:
-                flash = Z_Malloc(sizeof(*flash), PU_LEVEL, NULL);
+                flash = P_PoolAlloc(PT_LIGHTFLASH);
                 saveg_read_lightflash_t(flash);
                 flash->thinker.function = T_LightFlash;
                 P_AddThinker(&flash->thinker);
                 break;
 
             case tc_strobe:
-                strobe = Z_Malloc(sizeof(*strobe), PU_LEVEL, NULL);
+                strobe = P_PoolAlloc(PT_STROBE);
                 saveg_read_strobe_t(strobe);
                 strobe->thinker.function = T_StrobeFlash;
                 P_AddThinker(&strobe->thinker);
                 break;
 
             case tc_glow:
-                glow = Z_Malloc(sizeof(*glow), PU_LEVEL, NULL);
+                glow = P_PoolAlloc(PT_GLOW);
                 saveg_read_glow_t(glow);
                 glow->thinker.function = T_Glow;
                 P_AddThinker(&glow->thinker);
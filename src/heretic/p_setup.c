@@ -606,6 +606,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
     Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
 
     P_InitThinkers();
+    P_InitPools();
 
 //
 // look for a regular (development) map first
@@ -631,9 +632,11 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
     P_LoadSubsectors(lumpnum + ML_SSECTORS);
     P_LoadNodes(lumpnum + ML_NODES);
     P_LoadSegs(lumpnum + ML_SEGS);
+    R_PackLevelGeometry();
 
     P_GroupLines();
     P_LoadReject(lumpnum + ML_REJECT);
+    P_InitSightMatrix();
 
     bodyqueslot = 0;
     deathmatch_p = deathmatchstarts;
@@ -678,6 +681,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
 
 // set up world state
     P_SpawnSpecials();
+    P_StoreOldPositions();
 
 // build subsector connect matrix
 //      P_ConnectSubsectors ();
@@ -686,6 +690,12 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
     if (precache)
         R_PrecacheLevel();
 
+// load the rest, and build composite textures, while waiting for tics
+    R_StartIdlePrecache();
+
+// load the level's sound effects
+    S_PrecacheLevel();
+
 //printf ("free memory: 0x%x\n", Z_FreeMemory());
 
 }
@@ -15,10 +15,13 @@
 //
 // P_sight.c
 
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "doomdef.h"
 #include "p_local.h"
+#include "psram_allocator.h"
 
 /*
 ==============================================================================
@@ -35,6 +38,41 @@ fixed_t topslope, bottomslope;  // slopes to top and bottom of target
 
 int sightcounts[3];
 
+// Sector pairs that can never see each other: REJECT, plus every pair of
+// sectors that no chain of two-sided lines connects.  Indexed like REJECT.
+
+byte *sightmatrix;
+static boolean sightmatrixinsram;
+
+// Largest sightmatrix that is put in SRAM rather than the zone
+
+#ifndef SIGHTMATRIX_SRAM_MAX
+#define SIGHTMATRIX_SRAM_MAX (32 * 1024)
+#endif
+
+// Results of recent checks.  A check with the same looker, target and
+// positions in the same tic gets the same answer, unless a door, plat or
+// floor thinker has moved a plane in between, which bumps
+// sectorgeneration.
+
+#define SIGHTCACHESIZE 64       // must be a power of two
+
+typedef struct
+{
+    mobj_t *t1, *t2;
+    int tic;
+    unsigned int generation;
+    fixed_t x1, y1, x2, y2;
+    fixed_t zstart, top, bottom;
+    boolean result;
+} sightcache_t;
+
+static sightcache_t sightcache[SIGHTCACHESIZE];
+
+unsigned int sectorgeneration;
+
+int sightcachehits;
+
 /*
 ==============
 =
@@ -328,6 +366,7 @@ boolean P_CheckSight(mobj_t * t1, mobj_t * t2)
 {
     int s1, s2;
     int pnum, bytenum, bitnum;
+    sightcache_t *sc;
 
 //
 // check for trivial rejection
@@ -338,7 +377,7 @@ boolean P_CheckSight(mobj_t * t1, mobj_t * t2)
     bytenum = pnum >> 3;
     bitnum = 1 << (pnum & 7);
 
-    if (rejectmatrix[bytenum] & bitnum)
+    if (sightmatrix[bytenum] & bitnum)
     {
         sightcounts[0]++;
         return false;           // can't possibly be connected
@@ -351,5 +390,126 @@ boolean P_CheckSight(mobj_t * t1, mobj_t * t2)
     topslope = (t2->z + t2->height) - sightzstart;
     bottomslope = (t2->z) - sightzstart;
 
-    return P_SightPathTraverse(t1->x, t1->y, t2->x, t2->y);
+    sc = &sightcache[(((uintptr_t) t1 >> 3) ^ ((uintptr_t) t2 >> 5))
+                     & (SIGHTCACHESIZE - 1)];
+    if (sc->t1 == t1 && sc->t2 == t2 && sc->tic == leveltime
+     && sc->generation == sectorgeneration
+     && sc->x1 == t1->x && sc->y1 == t1->y
+     && sc->x2 == t2->x && sc->y2 == t2->y
+     && sc->zstart == sightzstart
+     && sc->top == topslope && sc->bottom == bottomslope)
+    {
+        sightcachehits++;
+        return sc->result;
+    }
+
+    sc->t1 = t1;
+    sc->t2 = t2;
+    sc->tic = leveltime;
+    sc->generation = sectorgeneration;
+    sc->x1 = t1->x;
+    sc->y1 = t1->y;
+    sc->x2 = t2->x;
+    sc->y2 = t2->y;
+    sc->zstart = sightzstart;
+    sc->top = topslope;
+    sc->bottom = bottomslope;
+    sc->result = P_SightPathTraverse(t1->x, t1->y, t2->x, t2->y);
+
+    return sc->result;
+}
+
+/*
+=====================
+=
+= P_FindSightGroup
+=
+=====================
+*/
+
+static int P_FindSightGroup(int *group, int s)
+{
+    while (group[s] != s)
+    {
+        group[s] = group[group[s]];
+        s = group[s];
+    }
+    return s;
+}
+
+/*
+=====================
+=
+= P_InitSightMatrix
+=
+= Builds sightmatrix from rejectmatrix once the level is loaded.  Sight
+= can only pass from one sector to another through two-sided lines, so
+= sectors are grouped by them and pairs in different groups are rejected
+= even if REJECT leaves them out.  The matrix goes in SRAM if it fits.
+=
+=====================
+*/
+
+void P_InitSightMatrix(void)
+{
+    int *group;
+    int size;
+    int i, j, g;
+    int pnum;
+    line_t *ld;
+
+    if (sightmatrixinsram)
+    {
+        free(sightmatrix);
+    }
+    sightmatrix = NULL;
+    sightmatrixinsram = false;
+    memset(sightcache, 0, sizeof(sightcache));
+
+    size = (numsectors * numsectors + 7) / 8;
+    if (size <= SIGHTMATRIX_SRAM_MAX)
+    {
+        sightmatrix = sram_try_malloc(size);
+        sightmatrixinsram = sightmatrix != NULL;
+    }
+    if (!sightmatrixinsram)
+    {
+        sightmatrix = Z_Malloc(size, PU_LEVEL, NULL);
+    }
+    memcpy(sightmatrix, rejectmatrix, size);
+
+    group = Z_Malloc(numsectors * sizeof(*group), PU_STATIC, NULL);
+    for (i = 0; i < numsectors; i++)
+    {
+        group[i] = i;
+    }
+    for (i = 0, ld = lines; i < numlines; i++, ld++)
+    {
+        if (ld->backsector == NULL)
+            continue;
+        g = P_FindSightGroup(group, ld->frontsector - sectors);
+        group[g] = P_FindSightGroup(group, ld->backsector - sectors);
+    }
+    g = 0;
+    for (i = 0; i < numsectors; i++)
+    {
+        group[i] = P_FindSightGroup(group, i);
+        if (group[i] != group[0])
+            g = 1;
+    }
+
+    // Usually the whole level is one group, and REJECT is all there is
+    for (i = 0; i < numsectors && g; i++)
+    {
+        for (j = 0; j < numsectors; j++)
+        {
+            if (group[i] != group[j])
+            {
+                pnum = i * numsectors + j;
+                sightmatrix[pnum >> 3] |= 1 << (pnum & 7);
+            }
+        }
+    }
+
+    Z_Free(group);
 }
@@ -1076,7 +1076,7 @@ int EV_DoDonut(line_t * line)
             //
             //      Spawn rising slime
             //
-            floor = Z_Malloc(sizeof(*floor), PU_LEVSPEC, 0);
+            floor = P_PoolAlloc(PT_FLOOR);
             P_AddThinker(&floor->thinker);
             s2->specialdata = floor;
             floor->thinker.function = T_MoveFloor;
@@ -1092,7 +1092,7 @@ int EV_DoDonut(line_t * line)
             //
             //      Spawn lowering donut-hole
             //
-            floor = Z_Malloc(sizeof(*floor), PU_LEVSPEC, 0);
+            floor = P_PoolAlloc(PT_FLOOR);
             P_AddThinker(&floor->thinker);
             s1->specialdata = floor;
             floor->thinker.function = T_MoveFloor;
@@ -1234,6 +1234,42 @@ void P_AddAmbientSfx(int sequence)
     LevelAmbientSfx[AmbSfxCount++] = AmbientSfx[sequence];
 }
 
+//----------------------------------------------------------------------------
+//
+// PROC P_MarkAmbientSfx
+//
+// Flags every sound referenced by the level's ambient sequences so that
+// (S_sound):S_PrecacheLevel can load them before play starts.
+//
+//----------------------------------------------------------------------------
+
+void P_MarkAmbientSfx(byte *sfxpresent)
+{
+    int i;
+    int *seq;
+
+    for (i = 0; i < AmbSfxCount; i++)
+    {
+        for (seq = LevelAmbientSfx[i]; *seq != afxcmd_end;)
+        {
+            switch (*seq++)
+            {
+                case afxcmd_play:
+                    sfxpresent[*seq++] = 1;
+                    break;
+                case afxcmd_playabsvol:
+                case afxcmd_playrelvol:
+                    sfxpresent[*seq] = 1;
+                    seq += 2;
+                    break;
+                default:        // afxcmd_delay, afxcmd_delayrand
+                    seq++;
+                    break;
+            }
+        }
+    }
+}
+
 //----------------------------------------------------------------------------
 //
 // PROC P_AmbientSound
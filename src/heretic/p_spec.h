@@ -71,6 +71,7 @@ void P_InitLava(void);
 void P_SpawnSpecials(void);
 void P_InitAmbientSound(void);
 void P_AddAmbientSfx(int sequence);
+void P_MarkAmbientSfx(byte *sfxpresent);
 
 // every tic
 void P_UpdateSpecials(void);
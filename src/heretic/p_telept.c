@@ -109,6 +109,15 @@ boolean P_Teleport(mobj_t * thing, fixed_t x, fixed_t y, angle_t angle)
     {
         thing->momx = thing->momy = thing->momz = 0;
     }
+    // Interpolated frames jump straight to the destination
+    thing->oldx = thing->x;
+    thing->oldy = thing->y;
+    thing->oldz = thing->z;
+    thing->oldangle = thing->angle;
+    if (thing->player)
+    {
+        thing->player->oldviewz = thing->player->viewz;
+    }
     return (true);
 }
 
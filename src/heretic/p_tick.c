@@ -18,18 +18,20 @@
 
 #include "doomdef.h"
 #include "i_system.h"
+#include "i_timer.h"
 #include "p_local.h"
 #include "v_video.h"
 
 int leveltime;
 int TimerGame;
+int oldpositionstime;           // I_GetTimeMS() of P_StoreOldPositions
 
 /*
 ===============================================================================
 
 								THINKERS
 
-All thinkers should be allocated by Z_Malloc so they can be operated on uniformly.  The actual
+All thinkers should be allocated by P_PoolAlloc so they can be operated on uniformly.  The actual
 structures will vary in size, but the first element must be thinker_t.
 
 ===============================================================================
@@ -37,6 +39,54 @@ structures will vary in size, but the first element must be thinker_t.
 
 thinker_t thinkercap;           // both the head and tail of the thinker list
 
+// Unless vanilla order is needed, thinkers are run a kind at a time from
+// separate lists, so that each pass keeps calling the same code.  New
+// thinkers wait on pendingcap until P_RunThinkers sees their function.
+// The lists link the thinkers where they are rather than copying their
+// fields into arrays: mobjs and movers are pointed to from all over the
+// game and from savegames, so they can't move.
+
+typedef enum
+{
+    RL_MOBJ,
+    RL_MOVER,                   // doors, floors, plats, ceilings
+    RL_LIGHT,
+    RL_OTHER,
+    NUMRUNLISTS
+} runlist_t;
+
+static thinker_t runcap[NUMRUNLISTS];
+static thinker_t pendingcap;
+
+// If non-zero, thinkers always run in the order they were added, as in
+// Vanilla.  Setting it to zero runs them from the per-kind lists in
+// single player games, which changes the sequence of random numbers, so
+// it is only a setting in heretic.cfg.  Demos and netgames always keep
+// Vanilla order.
+
+int vanilla_thinker_order = 1;
+
+static void P_InitRunList(thinker_t * cap)
+{
+    cap->runprev = cap->runnext = cap;
+}
+
+static void P_AddToRunList(thinker_t * cap, thinker_t * thinker)
+{
+    cap->runprev->runnext = thinker;
+    thinker->runnext = cap;
+    thinker->runprev = cap->runprev;
+    cap->runprev = thinker;
+}
+
+static void P_UnlinkThinker(thinker_t * thinker)
+{
+    thinker->next->prev = thinker->prev;
+    thinker->prev->next = thinker->next;
+    thinker->runnext->runprev = thinker->runprev;
+    thinker->runprev->runnext = thinker->runnext;
+}
+
 /*
 ===============
 =
@@ -47,7 +97,14 @@ thinker_t thinkercap;           // both the head and tail of the thinker list
 
 void P_InitThinkers(void)
 {
+    int i;
+
     thinkercap.prev = thinkercap.next = &thinkercap;
+    for (i = 0; i < NUMRUNLISTS; i++)
+    {
+        P_InitRunList(&runcap[i]);
+    }
+    P_InitRunList(&pendingcap);
 }
 
 
@@ -67,6 +124,7 @@ void P_AddThinker(thinker_t * thinker)
     thinker->next = &thinkercap;
     thinker->prev = thinkercap.prev;
     thinkercap.prev = thinker;
+    P_AddToRunList(&pendingcap, thinker);
 }
 
 /*
@@ -100,6 +158,30 @@ void P_AllocateThinker(thinker_t * thinker)
 }
 
 
+static runlist_t P_ThinkerRunList(thinker_t * thinker)
+{
+    think_t function = thinker->function;
+
+    if (function == P_MobjThinker)
+        return RL_MOBJ;
+    if (function == T_VerticalDoor || function == T_MoveFloor
+     || function == T_PlatRaise || function == T_MoveCeiling)
+        return RL_MOVER;
+    if (function == T_LightFlash || function == T_StrobeFlash
+     || function == T_Glow)
+        return RL_LIGHT;
+    return RL_OTHER;
+}
+
+// Moves a thinker from pendingcap to the run list for its function
+
+static void P_FileThinker(thinker_t * thinker)
+{
+    thinker->runnext->runprev = thinker->runprev;
+    thinker->runprev->runnext = thinker->runnext;
+    P_AddToRunList(&runcap[P_ThinkerRunList(thinker)], thinker);
+}
+
 /*
 ===============
 =
@@ -111,25 +193,111 @@ void P_AllocateThinker(thinker_t * thinker)
 void P_RunThinkers(void)
 {
     thinker_t *currentthinker, *nextthinker;
+    int i;
 
-    currentthinker = thinkercap.next;
-    while (currentthinker != &thinkercap)
+    // Sort thinkers added since the last tic
+    while (pendingcap.runnext != &pendingcap)
     {
-        if (currentthinker->function == (think_t) - 1)
-        {                       // time to remove it
-            nextthinker = currentthinker->next;
-            currentthinker->next->prev = currentthinker->prev;
-            currentthinker->prev->next = currentthinker->next;
-            Z_Free(currentthinker);
+        P_FileThinker(pendingcap.runnext);
+    }
+
+    if (vanilla_thinker_order || demoplayback || demorecording || netgame)
+    {
+        currentthinker = thinkercap.next;
+        while (currentthinker != &thinkercap)
+        {
+            if (currentthinker->function == (think_t) - 1)
+            {                   // time to remove it
+                nextthinker = currentthinker->next;
+                P_UnlinkThinker(currentthinker);
+                P_PoolFree(currentthinker);
+            }
+            else
+            {
+                if (currentthinker->function)
+                    currentthinker->function(currentthinker);
+                nextthinker = currentthinker->next;
+            }
+            currentthinker = nextthinker;
         }
-        else
+        return;
+    }
+
+    for (i = 0; i < NUMRUNLISTS; i++)
+    {
+        currentthinker = runcap[i].runnext;
+        while (currentthinker != &runcap[i])
         {
-            if (currentthinker->function)
+            nextthinker = currentthinker->runnext;
+            if (currentthinker->function == (think_t) - 1)
+            {                   // time to remove it
+                P_UnlinkThinker(currentthinker);
+                P_PoolFree(currentthinker);
+            }
+            else if (currentthinker->function)
+            {
                 currentthinker->function(currentthinker);
-            nextthinker = currentthinker->next;
+            }
+            currentthinker = nextthinker;
+        }
+    }
+
+    // Thinkers spawned during this tic get their first run now, as they
+    // would have at the end of the vanilla list
+    while (pendingcap.runnext != &pendingcap)
+    {
+        currentthinker = pendingcap.runnext;
+        P_FileThinker(currentthinker);
+        if (currentthinker->function == (think_t) - 1)
+        {
+            P_UnlinkThinker(currentthinker);
+            P_PoolFree(currentthinker);
+        }
+        else if (currentthinker->function)
+        {
+            currentthinker->function(currentthinker);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// PROC P_StoreOldPositions
+//
+// Keeps where things and sector planes are at the start of the tic, so
+// frames drawn before the next tic can be interpolated towards the new
+// positions.
+//
+//----------------------------------------------------------------------------
+
+void P_StoreOldPositions(void)
+{
+    thinker_t *th;
+    mobj_t *mo;
+    sector_t *sec;
+    int i;
+
+    for (th = thinkercap.next; th != &thinkercap; th = th->next)
+    {
+        if (th->function == P_MobjThinker)
+        {
+            mo = (mobj_t *) th;
+            mo->oldx = mo->x;
+            mo->oldy = mo->y;
+            mo->oldz = mo->z;
+            mo->oldangle = mo->angle;
         }
-        currentthinker = nextthinker;
     }
+    for (i = 0, sec = sectors; i < numsectors; i++, sec++)
+    {
+        sec->oldfloorheight = sec->floorheight;
+        sec->oldceilingheight = sec->ceilingheight;
+    }
+    for (i = 0; i < MAXPLAYERS; i++)
+    {
+        players[i].oldviewz = players[i].viewz;
+    }
+    oldpositionstime = I_GetTimeMS();
 }
 
 //----------------------------------------------------------------------------
@@ -146,6 +314,7 @@ void P_Ticker(void)
     {
         return;
     }
+    P_StoreOldPositions();
     for (i = 0; i < MAXPLAYERS; i++)
     {
         if (playeringame[i])
@@ -15,10 +15,14 @@
 //
 // R_bsp.c
 
+#include <stdlib.h>
+
 #include "doomdef.h"
 #include "i_system.h"
+#include "m_argv.h"
 #include "m_bbox.h"
 #include "i_system.h"
+#include "psram_allocator.h"
 #include "r_local.h"
 
 seg_t *curline;
@@ -28,6 +32,23 @@ sector_t *frontsector, *backsector;
 
 drawseg_t drawsegs[MAXDRAWSEGS], *ds_p;
 
+// Packed copy of the render-hot level geometry, see R_PackLevelGeometry.
+// NULL when the level is drawn from the vanilla structures.
+
+#ifndef R_SECOND_CORE
+bspnode_t *bspnodes;
+bspbox_t *bspboxes;
+bspseg_t *bspsegs;
+#endif
+
+// Columns of the view drawn by this renderer, see R_RenderViewRange
+int viewcolstart;
+int viewcolend;                 // one past the last column
+
+static void *packedblock;
+static boolean packedinsram;
+static int packednum;           // next node number handed out while packing
+
 void R_StoreWallRange(int start, int stop);
 
 /*
@@ -194,8 +215,8 @@ void R_ClipPassWallSegment(int first, int last)
 void R_ClearClipSegs(void)
 {
     solidsegs[0].first = -0x7fffffff;
-    solidsegs[0].last = -1;
-    solidsegs[1].first = viewwidth;
+    solidsegs[0].last = viewcolstart - 1;
+    solidsegs[1].first = viewcolend;
     solidsegs[1].last = 0x7fffffff;
     newend = solidsegs + 2;
 }
@@ -222,8 +243,18 @@ void R_AddLine(seg_t * line)
 
 // OPTIMIZE: quickly reject orthogonal back sides
 
-    angle1 = R_PointToAngle(line->v1->x, line->v1->y);
-    angle2 = R_PointToAngle(line->v2->x, line->v2->y);
+    if (bspsegs)
+    {
+        const bspseg_t *ps = &bspsegs[line - segs];
+
+        angle1 = R_PointToAngle(ps->x1 << FRACBITS, ps->y1 << FRACBITS);
+        angle2 = R_PointToAngle(ps->x2 << FRACBITS, ps->y2 << FRACBITS);
+    }
+    else
+    {
+        angle1 = R_PointToAngle(line->v1->x, line->v1->y);
+        angle2 = R_PointToAngle(line->v2->x, line->v2->y);
+    }
 
 //
 // clip to view edges
@@ -487,3 +518,250 @@ void R_RenderBSPNode(int bspnum)
     if (R_CheckBBox(bsp->bbox[side ^ 1]))       // possibly divide back space
         R_RenderBSPNode(bsp->children[side ^ 1]);
 }
+
+/*
+===============================================================================
+=
+= R_PointOnBspSide
+=
+= R_PointOnSide for a packed node; gives the same answer
+=
+===============================================================================
+*/
+
+int R_PointOnBspSide(fixed_t x, fixed_t y, const bspnode_t * node)
+{
+    fixed_t dx, dy;
+    fixed_t left, right;
+
+    if (!node->dx)
+    {
+        if (x <= node->x << FRACBITS)
+            return node->dy > 0;
+        return node->dy < 0;
+    }
+    if (!node->dy)
+    {
+        if (y <= node->y << FRACBITS)
+            return node->dx < 0;
+        return node->dx > 0;
+    }
+
+    dx = (x - (node->x << FRACBITS));
+    dy = (y - (node->y << FRACBITS));
+
+// try to quickly decide by looking at sign bits
+    if ((node->dy ^ node->dx ^ dx ^ dy) & 0x80000000)
+    {
+        if ((node->dy ^ dx) & 0x80000000)
+            return 1;           // (left is negative)
+        return 0;
+    }
+
+    left = FixedMul(node->dy, dx);
+    right = FixedMul(dy, node->dx);
+
+    if (right < left)
+        return 0;               // front side
+    return 1;                   // back side
+}
+
+/*
+===============================================================================
+=
+= R_RenderPackedNode
+=
+===============================================================================
+*/
+
+static void R_RenderPackedNode(int bspnum)
+{
+    const bspnode_t *bsp;
+    const short *box;
+    fixed_t bbox[4];
+    int side;
+
+    while (!(bspnum & NF_SUBSECTOR))
+    {
+        bsp = &bspnodes[bspnum];
+        side = R_PointOnBspSide(viewx, viewy, bsp);
+
+        R_RenderPackedNode(bsp->children[side]);
+
+        box = bspboxes[bspnum].bbox[side ^ 1];
+        bbox[BOXTOP] = box[BOXTOP] << FRACBITS;
+        bbox[BOXBOTTOM] = box[BOXBOTTOM] << FRACBITS;
+        bbox[BOXLEFT] = box[BOXLEFT] << FRACBITS;
+        bbox[BOXRIGHT] = box[BOXRIGHT] << FRACBITS;
+        if (!R_CheckBBox(bbox))
+            return;
+
+        // possibly divide back space, without recursing
+        bspnum = bsp->children[side ^ 1];
+    }
+
+    if (bspnum == -1)
+        R_Subsector(0);
+    else
+        R_Subsector(bspnum & (~NF_SUBSECTOR));
+}
+
+/*
+===============================================================================
+=
+= R_RenderBSP
+=
+= Walks the whole tree for the current view
+=
+===============================================================================
+*/
+
+void R_RenderBSP(void)
+{
+    if (bspnodes)
+        R_RenderPackedNode(0);
+    else
+        R_RenderBSPNode(numnodes - 1);  // the head node is the last node output
+}
+
+/*
+===============================================================================
+=
+= R_RenderViewRange
+=
+= Draws columns x1 to x2-1 of the view set up by R_SetupFrame.  Columns
+= outside the range start out solid, so walls, planes and sprites are
+= only drawn inside it.  With SPLIT_RENDER the second core runs its own
+= copy of the renderer (r_core1.c) on the other part of the view.
+=
+===============================================================================
+*/
+
+void R_RenderViewRange(int x1, int x2)
+{
+    viewcolstart = x1;
+    viewcolend = x2;
+    if (fixedcolormap)
+        walllights = scalelightfixed;
+    R_ClearClipSegs();
+    R_ClearDrawSegs();
+    R_ClearPlanes();
+    R_ClearSprites();
+    R_RenderBSP();
+    R_DrawPlanes();
+    R_DrawMasked();
+}
+
+/*
+===============================================================================
+=
+= R_PackLevelGeometry
+=
+= Repacks the nodes and seg endpoints the renderer walks every frame into
+= small parallel arrays.  Nodes are renumbered in depth first order from
+= the root so that a walk down the tree moves forwards through memory.
+= Map coordinates are whole units, so they fit in shorts.  The block goes
+= in SRAM if it is small enough, otherwise in the zone with the level.
+=
+===============================================================================
+*/
+
+static int R_NumberPackedNode(int bspnum, unsigned short *renumber)
+{
+    int num;
+
+    if (bspnum & NF_SUBSECTOR)
+        return bspnum;
+
+    num = packednum++;
+    renumber[bspnum] = num;
+    R_NumberPackedNode(nodes[bspnum].children[0], renumber);
+    R_NumberPackedNode(nodes[bspnum].children[1], renumber);
+    return num;
+}
+
+static unsigned short R_PackedChild(int child, const unsigned short *renumber)
+{
+    if (child & NF_SUBSECTOR)
+        return child;
+    return renumber[child];
+}
+
+void R_PackLevelGeometry(void)
+{
+    unsigned short *renumber;
+    const node_t *no;
+    bspnode_t *pn;
+    bspbox_t *pb;
+    size_t size;
+    int i, j, k;
+
+    // The old block went with the previous level
+    if (packedinsram)
+    {
+        free(packedblock);
+    }
+    packedblock = NULL;
+    packedinsram = false;
+    bspnodes = NULL;
+    bspboxes = NULL;
+    bspsegs = NULL;
+
+    //!
+    // @category obscure
+    //
+    // Draw levels straight from the vanilla node and seg structures
+    // instead of a packed copy.
+    //
+
+    if (numnodes == 0 || M_ParmExists("-nopackbsp"))
+        return;                 // single subsector, or packing disabled
+
+    size = numnodes * (sizeof(*bspnodes) + sizeof(*bspboxes))
+         + numsegs * sizeof(*bspsegs);
+
+    if (size <= PACKED_GEOMETRY_SRAM_MAX)
+    {
+        packedblock = sram_try_malloc(size);
+        packedinsram = packedblock != NULL;
+    }
+    if (!packedinsram)
+    {
+        packedblock = Z_Malloc(size, PU_LEVEL, NULL);
+    }
+
+    // Boxes first: they are the largest and need the most alignment
+    bspboxes = packedblock;
+    bspnodes = (bspnode_t *) (bspboxes + numnodes);
+    bspsegs = (bspseg_t *) (bspnodes + numnodes);
+
+    renumber = Z_Malloc(numnodes * sizeof(*renumber), PU_STATIC, NULL);
+    packednum = 0;
+    R_NumberPackedNode(numnodes - 1, renumber);
+
+    for (i = 0, no = nodes; i < numnodes; i++, no++)
+    {
+        pn = &bspnodes[renumber[i]];
+        pb = &bspboxes[renumber[i]];
+        pn->x = no->x >> FRACBITS;
+        pn->y = no->y >> FRACBITS;
+        pn->dx = no->dx >> FRACBITS;
+        pn->dy = no->dy >> FRACBITS;
+        for (j = 0; j < 2; j++)
+        {
+            pn->children[j] = R_PackedChild(no->children[j], renumber);
+            for (k = 0; k < 4; k++)
+                pb->bbox[j][k] = no->bbox[j][k] >> FRACBITS;
+        }
+    }
+
+    Z_Free(renumber);
+
+    for (i = 0; i < numsegs; i++)
+    {
+        bspsegs[i].x1 = segs[i].v1->x >> FRACBITS;
+        bspsegs[i].y1 = segs[i].v1->y >> FRACBITS;
+        bspsegs[i].x2 = segs[i].v2->x >> FRACBITS;
+        bspsegs[i].y2 = segs[i].v2->y >> FRACBITS;
+    }
+}
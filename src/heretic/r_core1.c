@@ -0,0 +1,35 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// R_core1.c
+//
+// Second copy of the view renderer for the second core.  The BSP walk,
+// segs, planes, sprites and column drawers keep their state in globals,
+// so rather than threading a context through every inner loop they are
+// compiled again here with those globals renamed (r_core1.h).  Each core
+// then draws its own range of columns with no sharing in the hot paths.
+
+#ifdef SPLIT_RENDER
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+
+#define R_SECOND_CORE
+#include "r_core1.h"
+
+#include "r_bsp.c"
+#include "r_segs.c"
+#include "r_plane.c"
+#include "r_things.c"
+#include "r_draw.c"
+
+#endif // SPLIT_RENDER
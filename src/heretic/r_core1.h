@@ -0,0 +1,188 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// R_core1.h
+//
+// Renames the per-view state and functions of the renderer for the copy
+// compiled by r_core1.c.  Anything the two cores share (the view size,
+// screen buffer, sky, sprite definitions and lookup tables) is defined
+// only by the first copy and keeps its name.  Struct members with the
+// same names are renamed too, which is harmless since the layout does
+// not change.
+
+#ifndef __R_CORE1__
+#define __R_CORE1__
+
+// R_bsp.c
+#define R_AddLine                    R_AddLine_c1
+#define R_CheckBBox                  R_CheckBBox_c1
+#define R_ClearClipSegs              R_ClearClipSegs_c1
+#define R_ClearDrawSegs              R_ClearDrawSegs_c1
+#define R_ClipPassWallSegment        R_ClipPassWallSegment_c1
+#define R_ClipSolidWallSegment       R_ClipSolidWallSegment_c1
+#define R_PackLevelGeometry          R_PackLevelGeometry_c1
+#define R_PointOnBspSide             R_PointOnBspSide_c1
+#define R_RenderBSP                  R_RenderBSP_c1
+#define R_RenderBSPNode              R_RenderBSPNode_c1
+#define R_RenderViewRange            R_RenderViewRange_c1
+#define R_Subsector                  R_Subsector_c1
+#define backsector                   backsector_c1
+#define checkcoord                   checkcoord_c1
+#define curline                      curline_c1
+#define drawsegs                     drawsegs_c1
+#define ds_p                         ds_p_c1
+#define frontsector                  frontsector_c1
+#define linedef                      linedef_c1
+#define newend                       newend_c1
+#define sidedef                      sidedef_c1
+#define solidsegs                    solidsegs_c1
+#define viewcolend                   viewcolend_c1
+#define viewcolstart                 viewcolstart_c1
+
+// R_segs.c
+#define R_RenderMaskedSegRange       R_RenderMaskedSegRange_c1
+#define R_RenderSegLoop              R_RenderSegLoop_c1
+#define R_ScaleFromGlobalAngle       R_ScaleFromGlobalAngle_c1
+#define R_StoreWallRange             R_StoreWallRange_c1
+#define bottomfrac                   bottomfrac_c1
+#define bottomstep                   bottomstep_c1
+#define bottomtexture                bottomtexture_c1
+#define markceiling                  markceiling_c1
+#define markfloor                    markfloor_c1
+#define maskedtexture                maskedtexture_c1
+#define maskedtexturecol             maskedtexturecol_c1
+#define midtexture                   midtexture_c1
+#define pixhigh                      pixhigh_c1
+#define pixhighstep                  pixhighstep_c1
+#define pixlow                       pixlow_c1
+#define pixlowstep                   pixlowstep_c1
+#define rw_angle1                    rw_angle1_c1
+#define rw_bottomtexturemid          rw_bottomtexturemid_c1
+#define rw_centerangle               rw_centerangle_c1
+#define rw_distance                  rw_distance_c1
+#define rw_midtexturemid             rw_midtexturemid_c1
+#define rw_normalangle               rw_normalangle_c1
+#define rw_offset                    rw_offset_c1
+#define rw_scale                     rw_scale_c1
+#define rw_scalestep                 rw_scalestep_c1
+#define rw_stopx                     rw_stopx_c1
+#define rw_toptexturemid             rw_toptexturemid_c1
+#define rw_x                         rw_x_c1
+#define segtextured                  segtextured_c1
+#define topfrac                      topfrac_c1
+#define topstep                      topstep_c1
+#define toptexture                   toptexture_c1
+#define walllights                   walllights_c1
+#define worldbottom                  worldbottom_c1
+#define worldhigh                    worldhigh_c1
+#define worldlow                     worldlow_c1
+#define worldtop                     worldtop_c1
+
+// R_plane.c
+#define R_CheckPlane                 R_CheckPlane_c1
+#define R_ClearPlanes                R_ClearPlanes_c1
+#define R_DrawPlanes                 R_DrawPlanes_c1
+#define R_FindPlane                  R_FindPlane_c1
+#define R_InitPlanes                 R_InitPlanes_c1
+#define R_InitSkyMap                 R_InitSkyMap_c1
+#define R_MakeSpans                  R_MakeSpans_c1
+#define R_MapPlane                   R_MapPlane_c1
+#define basexscale                   basexscale_c1
+#define baseyscale                   baseyscale_c1
+#define cacheddistance               cacheddistance_c1
+#define cachedheight                 cachedheight_c1
+#define cachedxstep                  cachedxstep_c1
+#define cachedystep                  cachedystep_c1
+#define ceilingclip                  ceilingclip_c1
+#define ceilingfunc                  ceilingfunc_c1
+#define ceilingplane                 ceilingplane_c1
+#define floorclip                    floorclip_c1
+#define floorfunc                    floorfunc_c1
+#define floorplane                   floorplane_c1
+#define lastopening                  lastopening_c1
+#define lastvisplane                 lastvisplane_c1
+#define openings                     openings_c1
+#define planeheight                  planeheight_c1
+#define planezlight                  planezlight_c1
+#define spanstart                    spanstart_c1
+#define spanstop                     spanstop_c1
+#define visplanes                    visplanes_c1
+
+// R_things.c
+#define PSpriteSY                    PSpriteSY_c1
+#define R_AddSprites                 R_AddSprites_c1
+#define R_ClearSprites               R_ClearSprites_c1
+#define R_DrawMasked                 R_DrawMasked_c1
+#define R_DrawMaskedColumn           R_DrawMaskedColumn_c1
+#define R_DrawPSprite                R_DrawPSprite_c1
+#define R_DrawPlayerSprites          R_DrawPlayerSprites_c1
+#define R_DrawSprite                 R_DrawSprite_c1
+#define R_DrawVisSprite              R_DrawVisSprite_c1
+#define R_GrowVisSprites             R_GrowVisSprites_c1
+#define R_InitSpriteDefs             R_InitSpriteDefs_c1
+#define R_InitSprites                R_InitSprites_c1
+#define R_InstallSpriteLump          R_InstallSpriteLump_c1
+#define R_NewVisSprite               R_NewVisSprite_c1
+#define R_ProjectSprite              R_ProjectSprite_c1
+#define R_SortVisSprites             R_SortVisSprites_c1
+#define maxframe                     maxframe_c1
+#define mceilingclip                 mceilingclip_c1
+#define mfloorclip                   mfloorclip_c1
+#define newvissprite                 newvissprite_c1
+#define overflowsprite               overflowsprite_c1
+#define sprbotscreen                 sprbotscreen_c1
+#define spritelights                 spritelights_c1
+#define spritename                   spritename_c1
+#define sprtemp                      sprtemp_c1
+#define sprtopscreen                 sprtopscreen_c1
+#define spryscale                    spryscale_c1
+#define vissprite_p                  vissprite_p_c1
+#define vissprites                   vissprites_c1
+
+// R_draw.c
+#define R_DrawColumn                 R_DrawColumn_c1
+#define R_DrawColumnLow              R_DrawColumnLow_c1
+#define R_DrawSpan                   R_DrawSpan_c1
+#define R_DrawSpanLow                R_DrawSpanLow_c1
+#define R_DrawTLColumn               R_DrawTLColumn_c1
+#define R_DrawTopBorder              R_DrawTopBorder_c1
+#define R_DrawTranslatedColumn       R_DrawTranslatedColumn_c1
+#define R_DrawTranslatedTLColumn     R_DrawTranslatedTLColumn_c1
+#define R_DrawViewBorder             R_DrawViewBorder_c1
+#define R_InitBuffer                 R_InitBuffer_c1
+#define R_InitTranslationTables      R_InitTranslationTables_c1
+#define R_SetDetailFuncs             R_SetDetailFuncs_c1
+#define basecolfunc                  basecolfunc_c1
+#define colfunc                      colfunc_c1
+#define dc_colormap                  dc_colormap_c1
+#define dc_iscale                    dc_iscale_c1
+#define dc_source                    dc_source_c1
+#define dc_texturemid                dc_texturemid_c1
+#define dc_translation               dc_translation_c1
+#define dc_x                         dc_x_c1
+#define dc_yh                        dc_yh_c1
+#define dc_yl                        dc_yl_c1
+#define dccount                      dccount_c1
+#define ds_colormap                  ds_colormap_c1
+#define ds_source                    ds_source_c1
+#define ds_x1                        ds_x1_c1
+#define ds_x2                        ds_x2_c1
+#define ds_xfrac                     ds_xfrac_c1
+#define ds_xstep                     ds_xstep_c1
+#define ds_y                         ds_y_c1
+#define ds_yfrac                     ds_yfrac_c1
+#define ds_ystep                     ds_ystep_c1
+#define dscount                      dscount_c1
+#define spanfunc                     spanfunc_c1
+#define tlcolfunc                    tlcolfunc_c1
+#define transcolfunc                 transcolfunc_c1
+
+#endif // __R_CORE1__
@@ -17,6 +17,7 @@
 // R_data.c
 
 #include "doomdef.h"
+#include "d_idle.h"
 #include "deh_str.h"
 
 #include "i_swap.h"
@@ -60,6 +61,14 @@ short **texturecolumnlump;
 unsigned short **texturecolumnofs;
 byte **texturecomposite;
 
+#ifdef SPLIT_RENDER
+// Composites used while a frame is split, held at PU_STATIC like the
+// lumps (W_PinLumps) until R_UnpinComposites
+static int *pinnedtextures;
+static int numpinnedtextures;
+static boolean pincomposites;
+#endif
+
 int *flattranslation;           // for global animation
 int *texturetranslation;        // for global animation
 
@@ -268,17 +277,62 @@ void R_GenerateLookup(int texnum)
 byte *R_GetColumn(int tex, int col)
 {
     int lump, ofs;
+    byte *column;
 
     col &= texturewidthmask[tex];
     lump = texturecolumnlump[tex][col];
     ofs = texturecolumnofs[tex][col];
     if (lump > 0)
         return (byte *) W_CacheLumpNum(lump, PU_CACHE) + ofs;
+
+    // the other render core may build or purge the composite
+    W_LockCache();
     if (!texturecomposite[tex])
         R_GenerateComposite(tex);
-    return texturecomposite[tex] + ofs;
+#ifdef SPLIT_RENDER
+    if (pincomposites && Z_GetTag(texturecomposite[tex]) >= PU_PURGELEVEL)
+    {
+        Z_ChangeTag(texturecomposite[tex], PU_STATIC);
+        pinnedtextures[numpinnedtextures++] = tex;
+    }
+#endif
+    column = texturecomposite[tex] + ofs;
+    W_UnlockCache();
+    return column;
 }
 
+#ifdef SPLIT_RENDER
+
+/*
+================
+=
+= R_PinComposites
+=
+= Holds every composite R_GetColumn returns until R_UnpinComposites,
+= while both render cores draw
+=
+================
+*/
+
+void R_PinComposites(void)
+{
+    pincomposites = true;
+}
+
+void R_UnpinComposites(void)
+{
+    int tex;
+
+    pincomposites = false;
+    while (numpinnedtextures > 0)
+    {
+        tex = pinnedtextures[--numpinnedtextures];
+        Z_ChangeTag(texturecomposite[tex], PU_CACHE);
+    }
+}
+
+#endif
+
 
 /*
 ==================
@@ -365,6 +419,9 @@ void R_InitTextures(void)
     texturecompositesize = Z_Malloc(numtextures * sizeof(int), PU_STATIC, 0);
     texturewidthmask = Z_Malloc(numtextures * sizeof(int), PU_STATIC, 0);
     textureheight = Z_Malloc(numtextures * sizeof(fixed_t), PU_STATIC, 0);
+#ifdef SPLIT_RENDER
+    pinnedtextures = Z_Malloc(numtextures * sizeof(int), PU_STATIC, 0);
+#endif
 
     for (i = 0; i < numtextures; i++, directory++)
     {
@@ -625,55 +682,37 @@ int R_TextureNumForName(const char *name)
 /*
 =================
 =
-= R_PrecacheLevel
+= R_MarkLevelGraphics
 =
-= Preloads all relevent graphics for the level
+= Flags the flats, wall patches and sprite lumps the level uses in
+= lumppresent [numlumps], and its wall textures in texturepresent
+= [numtextures]
 =================
 */
 
-int flatmemory, texturememory, spritememory;
-
-void R_PrecacheLevel(void)
+static void R_MarkLevelGraphics(byte *lumppresent, byte *texturepresent)
 {
-    char *flatpresent;
-    char *texturepresent;
-    char *spritepresent;
-    int i, j, k, lump;
+    int i, j, k;
     texture_t *texture;
     thinker_t *th;
     spriteframe_t *sf;
+    byte *spritepresent;
 
-    if (demoplayback)
-        return;
+    memset(lumppresent, 0, numlumps);
+    memset(texturepresent, 0, numtextures);
 
 //
-// precache flats
-//      
-    flatpresent = Z_Malloc(numflats, PU_STATIC, NULL);
-    memset(flatpresent, 0, numflats);
+// flats
+//
     for (i = 0; i < numsectors; i++)
     {
-        flatpresent[sectors[i].floorpic] = 1;
-        flatpresent[sectors[i].ceilingpic] = 1;
+        lumppresent[firstflat + sectors[i].floorpic] = 1;
+        lumppresent[firstflat + sectors[i].ceilingpic] = 1;
     }
 
-    flatmemory = 0;
-    for (i = 0; i < numflats; i++)
-        if (flatpresent[i])
-        {
-            lump = firstflat + i;
-            flatmemory += lumpinfo[lump]->size;
-            W_CacheLumpNum(lump, PU_CACHE);
-        }
-
-    Z_Free(flatpresent);
-
 //
-// precache textures
+// textures
 //
-    texturepresent = Z_Malloc(numtextures, PU_STATIC, NULL);
-    memset(texturepresent, 0, numtextures);
-
     for (i = 0; i < numsides; i++)
     {
         texturepresent[sides[i].toptexture] = 1;
@@ -683,24 +722,17 @@ void R_PrecacheLevel(void)
 
     texturepresent[skytexture] = 1;
 
-    texturememory = 0;
     for (i = 0; i < numtextures; i++)
     {
         if (!texturepresent[i])
             continue;
         texture = textures[i];
         for (j = 0; j < texture->patchcount; j++)
-        {
-            lump = texture->patches[j].patch;
-            texturememory += lumpinfo[lump]->size;
-            W_CacheLumpNum(lump, PU_CACHE);
-        }
+            lumppresent[texture->patches[j].patch] = 1;
     }
 
-    Z_Free(texturepresent);
-
 //
-// precache sprites
+// sprites
 //
     spritepresent = Z_Malloc(numsprites, PU_STATIC, NULL);
     memset(spritepresent, 0, numsprites);
@@ -711,7 +743,6 @@ void R_PrecacheLevel(void)
             spritepresent[((mobj_t *) th)->sprite] = 1;
     }
 
-    spritememory = 0;
     for (i = 0; i < numsprites; i++)
     {
         if (!spritepresent[i])
@@ -720,13 +751,123 @@ void R_PrecacheLevel(void)
         {
             sf = &sprites[i].spriteframes[j];
             for (k = 0; k < 8; k++)
-            {
-                lump = firstspritelump + sf->lump[k];
-                spritememory += lumpinfo[lump]->size;
-                W_CacheLumpNum(lump, PU_CACHE);
-            }
+                lumppresent[firstspritelump + sf->lump[k]] = 1;
         }
     }
 
     Z_Free(spritepresent);
 }
+
+
+/*
+=================
+=
+= R_PrecacheLevel
+=
+= Preloads all relevent graphics for the level
+=================
+*/
+
+int flatmemory, texturememory, spritememory;
+
+void R_PrecacheLevel(void)
+{
+    byte *lumppresent;
+    byte *texturepresent;
+    int lump;
+
+    if (demoplayback)
+        return;
+
+    lumppresent = Z_Malloc(numlumps, PU_STATIC, NULL);
+    texturepresent = Z_Malloc(numtextures, PU_STATIC, NULL);
+    R_MarkLevelGraphics(lumppresent, texturepresent);
+
+    flatmemory = 0;
+    texturememory = 0;
+    spritememory = 0;
+    for (lump = 0; lump < numlumps; lump++)
+    {
+        if (!lumppresent[lump])
+            continue;
+        if (lump >= firstflat && lump < firstflat + numflats)
+            flatmemory += lumpinfo[lump]->size;
+        else if (lump >= firstspritelump && lump <= lastspritelump)
+            spritememory += lumpinfo[lump]->size;
+        else
+            texturememory += lumpinfo[lump]->size;
+        W_CacheLumpNum(lump, PU_CACHE);
+    }
+
+    Z_Free(texturepresent);
+    Z_Free(lumppresent);
+}
+
+
+/*
+=================
+=
+= R_IdlePrecache
+=
+= Idle job that loads whatever graphics the level uses and are not in
+= memory yet, a lump at a time, then builds the composite textures that
+= would otherwise be built the first time they are seen
+=================
+*/
+
+static byte *idlelumps;
+static byte *idletextures;
+static int idlelump, idletexture;
+
+static boolean R_IdlePrecache(void)
+{
+    int lump, tex;
+
+    if (gamestate != GS_LEVEL)
+        return false;
+
+    while (idlelump < numlumps)
+    {
+        lump = idlelump++;
+        if (idlelumps[lump] && lumpinfo[lump]->cache == NULL
+            && lumpinfo[lump]->wad_file->mapped == NULL)
+        {
+            W_CacheLumpNum(lump, PU_CACHE);
+            return true;
+        }
+    }
+
+    while (idletexture < numtextures)
+    {
+        tex = idletexture++;
+        if (idletextures[tex] && texturecompositesize[tex]
+            && !texturecomposite[tex])
+        {
+            R_GenerateComposite(tex);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/*
+=================
+=
+= R_StartIdlePrecache
+=
+= Called once the level's things are spawned.  The lists are PU_LEVEL,
+= so they go with the level; the job stops when the level is left
+=================
+*/
+
+void R_StartIdlePrecache(void)
+{
+    idlelumps = Z_Malloc(numlumps, PU_LEVEL, NULL);
+    idletextures = Z_Malloc(numtextures, PU_LEVEL, NULL);
+    R_MarkLevelGraphics(idlelumps, idletextures);
+    idlelump = 0;
+    idletexture = 0;
+    D_StartIdleJob("R_IdlePrecache", R_IdlePrecache);
+}
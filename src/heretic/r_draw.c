@@ -29,11 +29,47 @@ files only know about ccordinates, not the architecture of the frame buffer.
 
 */
 
+#ifndef R_SECOND_CORE
 byte *viewimage;
 int viewwidth, scaledviewwidth, viewheight, viewwindowx, viewwindowy;
 byte *ylookup[MAXHEIGHT];
 int columnofs[MAXWIDTH];
 byte translations[3][256];      // color tables for different players
+#endif
+
+void (*colfunc) (void);
+void (*basecolfunc) (void);
+void (*tlcolfunc) (void);
+void (*transcolfunc) (void);
+void (*spanfunc) (void);
+
+/*
+==================
+=
+= R_SetDetailFuncs
+=
+= Points the column and span drawers at the high or low detail versions
+=
+==================
+*/
+
+void R_SetDetailFuncs(void)
+{
+    if (!detailshift)
+    {
+        colfunc = basecolfunc = R_DrawColumn;
+        tlcolfunc = R_DrawTLColumn;
+        transcolfunc = R_DrawTranslatedColumn;
+        spanfunc = R_DrawSpan;
+    }
+    else
+    {
+        colfunc = basecolfunc = R_DrawColumnLow;
+        tlcolfunc = R_DrawTLColumn;
+        transcolfunc = R_DrawTranslatedColumn;
+        spanfunc = R_DrawSpanLow;
+    }
+}
 
 /*
 ==================
@@ -186,7 +222,9 @@ void __not_in_flash_func(R_DrawTLColumn)(void)
 */
 
 byte *dc_translation;
+#ifndef R_SECOND_CORE
 byte *translationtables;
+#endif
 
 void __not_in_flash_func(R_DrawTranslatedColumn)(void)
 {
@@ -417,7 +455,9 @@ void R_InitBuffer(int width, int height)
 ==================
 */
 
+#ifndef R_SECOND_CORE
 boolean BorderNeedRefresh;
+#endif
 
 void R_DrawViewBorder(void)
 {
@@ -436,6 +476,7 @@ void R_DrawViewBorder(void)
         src = W_CacheLumpName(DEH_String("FLAT513"), PU_CACHE);
     }
     dest = I_VideoBuffer;
+    V_MarkRect(0, 0, SCREENWIDTH, SCREENHEIGHT - SBARHEIGHT);
 
     for (y = 0; y < SCREENHEIGHT - SBARHEIGHT; y++)
     {
@@ -483,7 +524,9 @@ void R_DrawViewBorder(void)
 ==================
 */
 
+#ifndef R_SECOND_CORE
 boolean BorderTopRefresh;
+#endif
 
 void R_DrawTopBorder(void)
 {
@@ -502,6 +545,7 @@ void R_DrawTopBorder(void)
         src = W_CacheLumpName(DEH_String("FLAT513"), PU_CACHE);
     }
     dest = I_VideoBuffer;
+    V_MarkRect(0, 0, SCREENWIDTH, 30);
 
     for (y = 0; y < 30; y++)
     {
@@ -36,6 +36,20 @@
 
 #define	FIELDOFVIEW		2048    // fineangles in the SCREENWIDTH wide window
 
+// With SPLIT_RENDER the second core draws part of the view with its own
+// copy of the renderer state, see r_core1.c
+#ifdef SPLIT_RENDER
+#define NUMRENDERCORES		2
+#else
+#define NUMRENDERCORES		1
+#endif
+
+#ifdef R_SECOND_CORE
+#define RENDERCORE			1
+#else
+#define RENDERCORE			0
+#endif
+
 //
 // lighting constants
 //
@@ -79,10 +93,16 @@ typedef struct
     degenmobj_t soundorg;       // for any sounds played by the sector
 
     int validcount;             // if == validcount, already checked
+    int spritevalid[NUMRENDERCORES];    // sprites added this frame
     mobj_t *thinglist;          // list of mobjs in sector
     void *specialdata;          // thinker_t for reversable actions
     int linecount;
     struct line_s **lines;      // [linecount] size
+
+    // heights at the start of the tic, and the real heights while
+    // interpolated ones are swapped in for a frame (R_RenderPlayerView)
+    fixed_t oldfloorheight, oldceilingheight;
+    fixed_t tickfloorheight, tickceilingheight;
 } sector_t;
 
 typedef struct
@@ -136,6 +156,30 @@ typedef struct
     unsigned short children[2]; // if NF_SUBSECTOR its a subsector
 } node_t;
 
+// Packed copies of the above for the renderer, in whole map units
+
+typedef struct
+{
+    short x, y, dx, dy;         // partition line
+    unsigned short children[2]; // packed node numbers, or NF_SUBSECTOR
+} bspnode_t;
+
+typedef struct
+{
+    short bbox[2][4];           // bounding box for each child
+} bspbox_t;
+
+typedef struct
+{
+    short x1, y1, x2, y2;       // seg endpoints
+} bspseg_t;
+
+// Largest packed geometry block that is put in SRAM rather than the zone
+
+#ifndef PACKED_GEOMETRY_SRAM_MAX
+#define PACKED_GEOMETRY_SRAM_MAX (48 * 1024)
+#endif
+
 
 /*
 ==============================================================================
@@ -189,7 +233,6 @@ typedef struct drawseg_s
 // A vissprite_t is a thing that will be drawn during a refresh
 typedef struct vissprite_s
 {
-    struct vissprite_s *prev, *next;
     int x1, x2;
     fixed_t gx, gy;             // for line side calculation
     fixed_t gz, gzt;            // global bottom / top for silhouette clipping
@@ -300,11 +343,14 @@ extern int screenblocks;
 extern void (*colfunc) (void);
 extern void (*basecolfunc) (void);
 extern void (*tlcolfunc) (void);
+extern void (*transcolfunc) (void);
 extern void (*spanfunc) (void);
 
 int R_PointOnSide(fixed_t x, fixed_t y, node_t * node);
 int R_PointOnSegSide(fixed_t x, fixed_t y, seg_t * line);
 angle_t R_PointToAngle(fixed_t x, fixed_t y);
+fixed_t R_Interpolate(fixed_t oldvalue, fixed_t value);
+angle_t R_InterpolateAngle(angle_t oldangle, angle_t angle);
 angle_t R_PointToAngle2(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2);
 fixed_t R_PointToDist(fixed_t x, fixed_t y);
 fixed_t R_ScaleFromGlobalAngle(angle_t visangle);
@@ -339,6 +385,16 @@ void R_ClearClipSegs(void);
 void R_ClearDrawSegs(void);
 void R_InitSkyMap(void);
 void R_RenderBSPNode(int bspnum);
+void R_RenderBSP(void);
+void R_RenderViewRange(int x1, int x2);
+int R_PointOnBspSide(fixed_t x, fixed_t y, const bspnode_t * node);
+void R_PackLevelGeometry(void);
+
+extern int viewcolstart, viewcolend;   // columns drawn by this core
+
+extern bspnode_t *bspnodes;     // NULL if the level is not packed
+extern bspbox_t *bspboxes;
+extern bspseg_t *bspsegs;
 
 //
 // R_segs.c
@@ -357,6 +413,8 @@ typedef void (*planefunction_t) (int top, int bottom);
 extern planefunction_t floorfunc, ceilingfunc;
 
 extern int skyflatnum;
+extern int skytexturemid;
+extern fixed_t skyiscale;
 
 extern short *openings, *lastopening;
 
@@ -402,17 +460,22 @@ extern int columnofs[MAXWIDTH];
 
 
 byte *R_GetColumn(int tex, int col);
+#ifdef SPLIT_RENDER
+void R_PinComposites(void);
+void R_UnpinComposites(void);
+#endif
 void R_InitData(void);
 void R_PrecacheLevel(void);
+void R_StartIdlePrecache(void);
 
 
 //
 // R_things.c
 //
-#define	MAXVISSPRITES	128
+#define	MAXVISSPRITES	128     // in SRAM
+#define	VISSPRITELIMIT	1024    // grown into the zone
 
-extern vissprite_t vissprites[MAXVISSPRITES], *vissprite_p;
-extern vissprite_t vsprsortedhead;
+extern vissprite_t *vissprites, *vissprite_p;
 
 // constant arrays used for psprite clipping and initializing clipping
 extern short negonearray[SCREENWIDTH];
@@ -437,6 +500,7 @@ void R_AddSprites(sector_t * sec);
 void R_AddPSprites(void);
 void R_DrawSprites(void);
 void R_InitSprites(const char **namelist);
+void R_GrowVisSprites(void);
 void R_ClearSprites(void);
 void R_DrawMasked(void);
 void R_ClipVisSprite(vissprite_t * vis, int xl, int xh);
@@ -481,7 +545,18 @@ extern byte *dc_translation;
 void R_DrawSpan(void);
 void R_DrawSpanLow(void);
 
+void R_SetDetailFuncs(void);
 void R_InitBuffer(int width, int height);
 void R_InitTranslationTables(void);
 
+#ifdef SPLIT_RENDER
+//
+// R_core1.c
+//
+void R_InitPlanes_c1(void);
+void R_SetDetailFuncs_c1(void);
+void R_RenderViewRange_c1(int x1, int x2);
+void R_GrowVisSprites_c1(void);
+#endif
+
 #endif // __R_LOCAL__
@@ -15,14 +15,27 @@
 //
 // R_main.c
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "doomdef.h"
 #include "m_bbox.h"
+#include "i_input.h"
+#include "psram_allocator.h"
 #include "r_local.h"
 #include "tables.h"
 
+#ifdef SPLIT_RENDER
+#include "pico/multicore.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#endif
+
 int viewangleoffset;
+angle_t viewanglelatch;
+boolean interpolateframe;
+fixed_t fractionaltic;
 
 // haleyjd: removed WATCOMC
 
@@ -65,12 +78,6 @@ lighttable_t *zlight[LIGHTLEVELS][MAXLIGHTZ];
 
 int extralight;                 // bumped light from gun blasts
 
-void (*colfunc) (void);
-void (*basecolfunc) (void);
-void (*tlcolfunc) (void);
-void (*transcolfunc) (void);
-void (*spanfunc) (void);
-
 /*
 ===================
 =
@@ -306,59 +313,30 @@ void R_InitPointToAngle(void)
 //=============================================================================
 
 /*
-================
+=================
+=
+= R_MirrorTable
 =
-= R_ScaleFromGlobalAngle
+= Returns a copy of a table in SRAM, or the table itself if there is
+= no room
 =
-= Returns the texture mapping scale for the current line at the given angle
-= rw_distance must be calculated first
-================
+=================
 */
 
-fixed_t R_ScaleFromGlobalAngle(angle_t visangle)
+static void *R_MirrorTable(const void *table, size_t size, int *sram)
 {
-    fixed_t scale;
-    int anglea, angleb;
-    int sinea, sineb;
-    fixed_t num, den;
+    void *copy;
 
-#if 0
+    copy = sram_try_malloc(size);
+    if (copy == NULL)
     {
-        fixed_t dist, z;
-        fixed_t sinv, cosv;
-
-        sinv = finesine[(visangle - rw_normalangle) >> ANGLETOFINESHIFT];
-        dist = FixedDiv(rw_distance, sinv);
-        cosv = finecosine[(viewangle - visangle) >> ANGLETOFINESHIFT];
-        z = abs(FixedMul(dist, cosv));
-        scale = FixedDiv(projection, z);
-        return scale;
-    }
-#endif
-
-    anglea = ANG90 + (visangle - viewangle);
-    angleb = ANG90 + (visangle - rw_normalangle);
-// bothe sines are allways positive
-    sinea = finesine[anglea >> ANGLETOFINESHIFT];
-    sineb = finesine[angleb >> ANGLETOFINESHIFT];
-    num = FixedMul(projection, sineb) << detailshift;
-    den = FixedMul(rw_distance, sinea);
-    if (den > num >> 16)
-    {
-        scale = FixedDiv(num, den);
-        if (scale > 64 * FRACUNIT)
-            scale = 64 * FRACUNIT;
-        else if (scale < 256)
-            scale = 256;
+        return (void *) table;
     }
-    else
-        scale = 64 * FRACUNIT;
-
-    return scale;
+    memcpy(copy, table, size);
+    *sram += size;
+    return copy;
 }
 
-
-
 /*
 =================
 =
@@ -369,6 +347,8 @@ fixed_t R_ScaleFromGlobalAngle(angle_t visangle)
 
 void R_InitTables(void)
 {
+    int sram = 0;
+
 // now getting from tables.c
 #if 0
     int i;
@@ -398,6 +378,34 @@ void R_InitTables(void)
     }
 #endif
 
+// The tables are read from flash through the XIP cache, which the PSRAM
+// shares.  Copy the hot ones to SRAM, leaving any that do not fit.
+#ifdef TABLES_QUARTER_WAVE
+    finesinequarter = R_MirrorTable(finesine_rom,
+                                    FINEANGLES / 4 * sizeof(fixed_t), &sram);
+#endif
+    if (SRAM_TABLES & SRAM_TABLE_FINESINE)
+    {
+        finesine = R_MirrorTable(finesine_rom, sizeof(finesine_rom), &sram);
+        finecosine = &finesine[FINEANGLES / 4];
+    }
+    if (SRAM_TABLES & SRAM_TABLE_FINETANGENT)
+    {
+        finetangent = R_MirrorTable(finetangent_rom,
+                                    sizeof(finetangent_rom), &sram);
+    }
+    if (SRAM_TABLES & SRAM_TABLE_TANTOANGLE)
+    {
+        tantoangle = R_MirrorTable(tantoangle_rom,
+                                   sizeof(tantoangle_rom), &sram);
+    }
+    if (SRAM_TABLES & SRAM_TABLE_GAMMA)
+    {
+        gammatable = R_MirrorTable(gammatable_rom,
+                                   sizeof(gammatable_rom), &sram);
+    }
+
+    printf("R_InitTables: %d bytes of tables in SRAM\n", sram);
 }
 
 
@@ -570,20 +578,10 @@ void R_ExecuteSetViewSize(void)
     centeryfrac = centery << FRACBITS;
     projection = centerxfrac;
 
-    if (!detailshift)
-    {
-        colfunc = basecolfunc = R_DrawColumn;
-        tlcolfunc = R_DrawTLColumn;
-        transcolfunc = R_DrawTranslatedColumn;
-        spanfunc = R_DrawSpan;
-    }
-    else
-    {
-        colfunc = basecolfunc = R_DrawColumnLow;
-        tlcolfunc = R_DrawTLColumn;
-        transcolfunc = R_DrawTranslatedColumn;
-        spanfunc = R_DrawSpanLow;
-    }
+    R_SetDetailFuncs();
+#ifdef SPLIT_RENDER
+    R_SetDetailFuncs_c1();
+#endif
 
     R_InitBuffer(scaledviewwidth, viewheight);
 
@@ -643,6 +641,104 @@ void R_ExecuteSetViewSize(void)
 }
 
 
+#ifdef SPLIT_RENDER
+
+// The second core draws the columns from splitx to the right edge of the
+// view with its own renderer (r_core1.c), while this core draws the rest.
+// The split follows the time each side took on the last frame, so that
+// both usually finish together whatever is in front of the player.
+
+static int splitx;
+static uint32_t core1time;
+static uint32_t core1stack[2048];   // the BSP walk recurses
+
+static void R_SecondCoreMain(void)
+{
+    uint32_t start;
+    int x1;
+
+    while (1)
+    {
+        x1 = (int) multicore_fifo_pop_blocking();
+        start = time_us_32();
+        R_RenderViewRange_c1(x1, viewwidth);
+        core1time = time_us_32() - start;
+        __dmb();                // publish the columns before the reply
+        multicore_fifo_push_blocking(0);
+    }
+}
+
+/*
+==============
+=
+= R_StartSecondCore
+=
+==============
+*/
+
+static void R_StartSecondCore(void)
+{
+    R_InitPlanes_c1();
+    multicore_launch_core1_with_stack(R_SecondCoreMain, core1stack,
+                                      sizeof(core1stack));
+}
+
+/*
+==============
+=
+= R_RenderSplitView
+=
+==============
+*/
+
+static void R_RenderSplitView(void)
+{
+    uint32_t start, core0time;
+    int64_t den;
+    int target;
+
+    if (splitx < viewwidth / 4)
+    {
+        splitx = viewwidth / 4;
+    }
+    else if (splitx > viewwidth - viewwidth / 4)
+    {
+        splitx = viewwidth - viewwidth / 4;
+    }
+
+    R_GrowVisSprites();
+    R_GrowVisSprites_c1();
+
+    // Neither core may purge a lump or composite that the other is
+    // drawing from, so everything used by the frame is held until both
+    // have finished
+    W_PinLumps();
+    R_PinComposites();
+
+    __dmb();                    // frame setup before the second core reads it
+    multicore_fifo_push_blocking(splitx);
+    start = time_us_32();
+    R_RenderViewRange(0, splitx);
+    core0time = time_us_32() - start;
+    multicore_fifo_pop_blocking();
+    __dmb();
+
+    R_UnpinComposites();
+    W_UnpinLumps();
+
+    // Move the split halfway to where the time per column of each side
+    // says they would have finished together
+    den = (int64_t) core0time * (viewwidth - splitx)
+        + (int64_t) core1time * splitx;
+    if (den > 0)
+    {
+        target = (int) ((int64_t) viewwidth * core1time * splitx / den);
+        splitx += (target - splitx) / 2;
+    }
+}
+
+#endif // SPLIT_RENDER
+
 /*
 ==============
 =
@@ -678,6 +774,9 @@ void R_Init(void)
     printf (".");
     R_InitTranslationTables();
     framecount = 0;
+#ifdef SPLIT_RENDER
+    R_StartSecondCore();
+#endif
 }
 
 
@@ -697,6 +796,17 @@ subsector_t *R_PointInSubsector(fixed_t x, fixed_t y)
     if (!numnodes)              // single subsector is a special case
         return subsectors;
 
+    if (bspnodes)
+    {
+        nodenum = 0;
+        while (!(nodenum & NF_SUBSECTOR))
+        {
+            side = R_PointOnBspSide(x, y, &bspnodes[nodenum]);
+            nodenum = bspnodes[nodenum].children[side];
+        }
+        return &subsectors[nodenum & ~NF_SUBSECTOR];
+    }
+
     nodenum = numnodes - 1;
 
     while (!(nodenum & NF_SUBSECTOR))
@@ -710,6 +820,81 @@ subsector_t *R_PointInSubsector(fixed_t x, fixed_t y)
 
 }
 
+//----------------------------------------------------------------------------
+//
+// FUNC R_Interpolate
+//
+// Value between the start and end of the tic, fractionaltic of the way.
+//
+//----------------------------------------------------------------------------
+
+fixed_t R_Interpolate(fixed_t oldvalue, fixed_t value)
+{
+    return oldvalue + FixedMul(value - oldvalue, fractionaltic);
+}
+
+//----------------------------------------------------------------------------
+//
+// FUNC R_InterpolateAngle
+//
+// Turns the short way round.
+//
+//----------------------------------------------------------------------------
+
+angle_t R_InterpolateAngle(angle_t oldangle, angle_t angle)
+{
+    return oldangle + FixedMul((int) (angle - oldangle), fractionaltic);
+}
+
+//----------------------------------------------------------------------------
+//
+// PROC R_InterpolateSectors
+//
+// Swaps interpolated heights into the sectors that moved this tic.
+// R_RestoreSectors puts the real heights back after the frame.
+//
+//----------------------------------------------------------------------------
+
+static void R_InterpolateSectors(void)
+{
+    sector_t *sec;
+    int i;
+
+    for (i = 0, sec = sectors; i < numsectors; i++, sec++)
+    {
+        sec->tickfloorheight = sec->floorheight;
+        sec->tickceilingheight = sec->ceilingheight;
+        if (sec->floorheight != sec->oldfloorheight)
+        {
+            sec->floorheight = R_Interpolate(sec->oldfloorheight,
+                                             sec->floorheight);
+        }
+        if (sec->ceilingheight != sec->oldceilingheight)
+        {
+            sec->ceilingheight = R_Interpolate(sec->oldceilingheight,
+                                               sec->ceilingheight);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// PROC R_RestoreSectors
+//
+//----------------------------------------------------------------------------
+
+static void R_RestoreSectors(void)
+{
+    sector_t *sec;
+    int i;
+
+    for (i = 0, sec = sectors; i < numsectors; i++, sec++)
+    {
+        sec->floorheight = sec->tickfloorheight;
+        sec->ceilingheight = sec->tickceilingheight;
+    }
+}
+
 //----------------------------------------------------------------------------
 //
 // PROC R_SetupFrame
@@ -721,25 +906,45 @@ void R_SetupFrame(player_t * player)
     int i;
     int tableAngle;
     int tempCentery;
+    mobj_t *mo;
 
     //drawbsp = 1;
     viewplayer = player;
+    mo = player->mo;
     // haleyjd: removed WATCOMC
     // haleyjd FIXME: viewangleoffset handling?
-    viewangle = player->mo->angle + viewangleoffset;
+    viewangle = mo->angle + viewangleoffset;
+    if (player == &players[consoleplayer])
+    {
+        viewangle += viewanglelatch;
+    }
+    // Latched mouse turns are already shown ahead of the tic, so the
+    // local view angle is not interpolated back behind them
+    if (interpolateframe && (player != &players[consoleplayer]
+                             || !mouse_late_latch || demoplayback))
+    {
+        viewangle = R_InterpolateAngle(mo->oldangle, mo->angle)
+                  + viewangleoffset;
+    }
     tableAngle = viewangle >> ANGLETOFINESHIFT;
-    if (player->chickenTics && player->chickenPeck)
-    {                           // Set chicken attack view position
-        viewx = player->mo->x + player->chickenPeck * finecosine[tableAngle];
-        viewy = player->mo->y + player->chickenPeck * finesine[tableAngle];
+    if (interpolateframe)
+    {
+        viewx = R_Interpolate(mo->oldx, mo->x);
+        viewy = R_Interpolate(mo->oldy, mo->y);
+        viewz = R_Interpolate(player->oldviewz, player->viewz);
     }
     else
-    {                           // Normal view position
-        viewx = player->mo->x;
-        viewy = player->mo->y;
+    {
+        viewx = mo->x;
+        viewy = mo->y;
+        viewz = player->viewz;
+    }
+    if (player->chickenTics && player->chickenPeck)
+    {                           // Set chicken attack view position
+        viewx += player->chickenPeck * finecosine[tableAngle];
+        viewy += player->chickenPeck * finesine[tableAngle];
     }
     extralight = player->extralight;
-    viewz = player->viewz;
 
     tempCentery = viewheight / 2 + (player->lookdir) * screenblocks / 10;
     if (centery != tempCentery)
@@ -760,7 +965,6 @@ void R_SetupFrame(player_t * player)
     {
         fixedcolormap = colormaps + player->fixedcolormap
             * 256 * sizeof(lighttable_t);
-        walllights = scalelightfixed;
         for (i = 0; i < MAXLIGHTSCALE; i++)
         {
             scalelightfixed[i] = fixedcolormap;
@@ -803,16 +1007,21 @@ void R_SetupFrame(player_t * player)
 
 void R_RenderPlayerView(player_t * player)
 {
+    if (interpolateframe)
+    {
+        R_InterpolateSectors();
+    }
     R_SetupFrame(player);
-    R_ClearClipSegs();
-    R_ClearDrawSegs();
-    R_ClearPlanes();
-    R_ClearSprites();
-    NetUpdate();                // check for new console commands
-    R_RenderBSPNode(numnodes - 1);      // the head node is the last node output
     NetUpdate();                // check for new console commands
-    R_DrawPlanes();
-    NetUpdate();                // check for new console commands
-    R_DrawMasked();
+#ifdef SPLIT_RENDER
+    R_RenderSplitView();
+#else
+    R_GrowVisSprites();
+    R_RenderViewRange(0, viewwidth);
+#endif
     NetUpdate();                // check for new console commands
+    if (interpolateframe)
+    {
+        R_RestoreSectors();
+    }
 }
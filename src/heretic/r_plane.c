@@ -28,10 +28,12 @@ planefunction_t floorfunc, ceilingfunc;
 //
 // sky mapping
 //
+#ifndef R_SECOND_CORE
 int skyflatnum;
 int skytexture;
 int skytexturemid;
 fixed_t skyiscale;
+#endif
 
 //
 // opening
@@ -65,8 +67,10 @@ int spanstop[SCREENHEIGHT];
 lighttable_t **planezlight;
 fixed_t planeheight;
 
+#ifndef R_SECOND_CORE
 fixed_t yslope[SCREENHEIGHT];
 fixed_t distscale[SCREENWIDTH];
+#endif
 fixed_t basexscale, baseyscale;
 
 fixed_t cachedheight[SCREENHEIGHT];
@@ -155,8 +159,8 @@ void __not_in_flash_func(R_MapPlane)(int y, int x1, int x2)
 
     length = FixedMul(distance, distscale[x1]);
     angle = (viewangle + xtoviewangle[x1]) >> ANGLETOFINESHIFT;
-    ds_xfrac = viewx + FixedMul(finecosine[angle], length);
-    ds_yfrac = -viewy - FixedMul(finesine[angle], length);
+    ds_xfrac = viewx + FixedMul(FINECOSINE(angle), length);
+    ds_yfrac = -viewy - FixedMul(FINESINE(angle), length);
 
     if (fixedcolormap)
         ds_colormap = fixedcolormap;
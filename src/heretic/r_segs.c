@@ -66,6 +66,59 @@ lighttable_t **walllights;
 
 short *maskedtexturecol;
 
+/*
+================
+=
+= R_ScaleFromGlobalAngle
+=
+= Returns the texture mapping scale for the current line at the given angle
+= rw_distance must be calculated first
+================
+*/
+
+fixed_t R_ScaleFromGlobalAngle(angle_t visangle)
+{
+    fixed_t scale;
+    int anglea, angleb;
+    int sinea, sineb;
+    fixed_t num, den;
+
+#if 0
+    {
+        fixed_t dist, z;
+        fixed_t sinv, cosv;
+
+        sinv = finesine[(visangle - rw_normalangle) >> ANGLETOFINESHIFT];
+        dist = FixedDiv(rw_distance, sinv);
+        cosv = finecosine[(viewangle - visangle) >> ANGLETOFINESHIFT];
+        z = abs(FixedMul(dist, cosv));
+        scale = FixedDiv(projection, z);
+        return scale;
+    }
+#endif
+
+    anglea = ANG90 + (visangle - viewangle);
+    angleb = ANG90 + (visangle - rw_normalangle);
+// bothe sines are allways positive
+    sinea = FINESINE(anglea >> ANGLETOFINESHIFT);
+    sineb = FINESINE(angleb >> ANGLETOFINESHIFT);
+    num = FixedMul(projection, sineb) << detailshift;
+    den = FixedMul(rw_distance, sinea);
+    if (den > num >> 16)
+    {
+        scale = FixedDiv(num, den);
+        if (scale > 64 * FRACUNIT)
+            scale = 64 * FRACUNIT;
+        else if (scale < 256)
+            scale = 256;
+    }
+    else
+        scale = 64 * FRACUNIT;
+
+    return scale;
+}
+
+
 /*
 ================
 =
@@ -362,7 +415,7 @@ void R_StoreWallRange(int start, int stop)
         offsetangle = ANG90;
     distangle = ANG90 - offsetangle;
     hyp = R_PointToDist(curline->v1->x, curline->v1->y);
-    sineval = finesine[distangle >> ANGLETOFINESHIFT];
+    sineval = FINESINE(distangle >> ANGLETOFINESHIFT);
     rw_distance = FixedMul(hyp, sineval);
 
 
@@ -554,7 +607,7 @@ void R_StoreWallRange(int start, int stop)
             offsetangle = -offsetangle;
         if (offsetangle > ANG90)
             offsetangle = ANG90;
-        sineval = finesine[offsetangle >> ANGLETOFINESHIFT];
+        sineval = FINESINE(offsetangle >> ANGLETOFINESHIFT);
         rw_offset = FixedMul(hyp, sineval);
         if (rw_normalangle - rw_angle1 < ANG180)
             rw_offset = -rw_offset;
@@ -16,6 +16,7 @@
 // R_things.c
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "doomdef.h"
 #include "deh_str.h"
 #include "i_swap.h"
@@ -40,13 +41,17 @@ This is not the same as the angle, which increases counter clockwise
 */
 
 
+#ifndef R_SECOND_CORE
 fixed_t pspritescale, pspriteiscale;
+#endif
 
 lighttable_t **spritelights;
 
+#ifndef R_SECOND_CORE
 // constant arrays used for psprite clipping and initializing clipping
 short negonearray[SCREENWIDTH];
 short screenheightarray[SCREENWIDTH];
+#endif
 
 /*
 ===============================================================================
@@ -57,8 +62,10 @@ short screenheightarray[SCREENWIDTH];
 */
 
 // variables used to look up and range check thing_t sprites patches
+#ifndef R_SECOND_CORE
 spritedef_t *sprites;
 int numsprites;
+#endif
 
 spriteframe_t sprtemp[26];
 int maxframe;
@@ -242,9 +249,31 @@ void R_InitSpriteDefs(const char **namelist)
 ===============================================================================
 */
 
-vissprite_t vissprites[MAXVISSPRITES], *vissprite_p;
+// The first MAXVISSPRITES sprites of a frame are in SRAM.  A view with
+// more moves them to a bigger block from the zone before the next frame,
+// up to VISSPRITELIMIT.
+static vissprite_t visspritebase[MAXVISSPRITES];
+static vissprite_t *vsprsortbase[MAXVISSPRITES * 2];
+
+vissprite_t *vissprites = visspritebase, *vissprite_p;
+static int maxvissprites = MAXVISSPRITES;
+static boolean visspritesfull;
 int newvissprite;
 
+// R_SortVisSprites sorts pointers in one half of this array using the
+// other half, and leaves vsprsorted pointing at the half with the result
+static vissprite_t **vsprsortspace = vsprsortbase;
+static vissprite_t **vsprsorted;
+
+// Drawsegs that can clip a sprite, as one bit per drawseg for each bin
+// of 32 columns, so that R_DrawSprite only visits the segs that overlap
+// the sprite
+#define DSBINSHIFT      5
+#define NUMDSBINS       ((SCREENWIDTH >> DSBINSHIFT) + 1)
+#define DSBITWORDS      ((MAXDRAWSEGS + 31) / 32)
+
+static unsigned int dsbins[NUMDSBINS][DSBITWORDS];
+
 
 /*
 ===================
@@ -283,6 +312,39 @@ void R_ClearSprites(void)
 }
 
 
+/*
+===================
+=
+= R_GrowVisSprites
+=
+= Doubles the vissprite pool if the last frame ran out.  Called before
+= the frame, while no other core is drawing, as the zone allocation can
+= purge cached lumps.
+===================
+*/
+
+void R_GrowVisSprites(void)
+{
+    int count;
+
+    if (!visspritesfull || maxvissprites >= VISSPRITELIMIT)
+        return;
+
+    count = maxvissprites * 2;
+    if (vissprites != visspritebase)
+    {
+        Z_Free(vissprites);
+        Z_Free(vsprsortspace);
+    }
+    vissprites = Z_Malloc(count * sizeof(*vissprites), PU_STATIC, NULL);
+    vsprsortspace = Z_Malloc(count * 2 * sizeof(*vsprsortspace),
+                             PU_STATIC, NULL);
+    vissprite_p = vissprites;
+    maxvissprites = count;
+    visspritesfull = false;
+}
+
+
 /*
 ===================
 =
@@ -295,8 +357,11 @@ vissprite_t overflowsprite;
 
 vissprite_t *R_NewVisSprite(void)
 {
-    if (vissprite_p == &vissprites[MAXVISSPRITES])
+    if (vissprite_p == vissprites + maxvissprites)
+    {
+        visspritesfull = true;
         return &overflowsprite;
+    }
     vissprite_p++;
     return vissprite_p - 1;
 }
@@ -470,17 +535,31 @@ void R_ProjectSprite(mobj_t * thing)
     vissprite_t *vis;
     angle_t ang;
     fixed_t iscale;
+    fixed_t thingx, thingy, thingz;
 
     if (thing->flags2 & MF2_DONTDRAW)
     {                           // Never make a vissprite when MF2_DONTDRAW is flagged.
         return;
     }
 
+    if (interpolateframe)
+    {
+        thingx = R_Interpolate(thing->oldx, thing->x);
+        thingy = R_Interpolate(thing->oldy, thing->y);
+        thingz = R_Interpolate(thing->oldz, thing->z);
+    }
+    else
+    {
+        thingx = thing->x;
+        thingy = thing->y;
+        thingz = thing->z;
+    }
+
 //
 // transform the origin point
 //
-    trx = thing->x - viewx;
-    try = thing->y - viewy;
+    trx = thingx - viewx;
+    try = thingy - viewy;
 
     gxt = FixedMul(trx, viewcos);
     gyt = -FixedMul(try, viewsin);
@@ -514,7 +593,7 @@ void R_ProjectSprite(mobj_t * thing)
 
     if (sprframe->rotate)
     {                           // choose a different rotation based on player view
-        ang = R_PointToAngle(thing->x, thing->y);
+        ang = R_PointToAngle(thingx, thingy);
         rot = (ang - thing->angle + (unsigned) (ANG45 / 2) * 9) >> 29;
         lump = sprframe->lump[rot];
         flip = (boolean) sprframe->flip[rot];
@@ -530,11 +609,11 @@ void R_ProjectSprite(mobj_t * thing)
 //
     tx -= spriteoffset[lump];
     x1 = (centerxfrac + FixedMul(tx, xscale)) >> FRACBITS;
-    if (x1 > viewwidth)
+    if (x1 > viewcolend)
         return;                 // off the right side
     tx += spritewidth[lump];
     x2 = ((centerxfrac + FixedMul(tx, xscale)) >> FRACBITS) - 1;
-    if (x2 < 0)
+    if (x2 < viewcolstart)
         return;                 // off the left side
 
 
@@ -545,14 +624,14 @@ void R_ProjectSprite(mobj_t * thing)
     vis->mobjflags = thing->flags;
     vis->psprite = false;
     vis->scale = xscale << detailshift;
-    vis->gx = thing->x;
-    vis->gy = thing->y;
-    vis->gz = thing->z;
-    vis->gzt = thing->z + spritetopoffset[lump];
+    vis->gx = thingx;
+    vis->gy = thingy;
+    vis->gz = thingz;
+    vis->gzt = thingz + spritetopoffset[lump];
 
     // foot clipping
     if (thing->flags2 & MF2_FEETARECLIPPED
-        && thing->z <= thing->subsector->sector->floorheight)
+        && thingz <= thing->subsector->sector->floorheight)
     {
         vis->footclip = 10;
     }
@@ -560,8 +639,8 @@ void R_ProjectSprite(mobj_t * thing)
         vis->footclip = 0;
     vis->texturemid = vis->gzt - viewz - (vis->footclip << FRACBITS);
 
-    vis->x1 = x1 < 0 ? 0 : x1;
-    vis->x2 = x2 >= viewwidth ? viewwidth - 1 : x2;
+    vis->x1 = x1 < viewcolstart ? viewcolstart : x1;
+    vis->x2 = x2 >= viewcolend ? viewcolend - 1 : x2;
     iscale = FixedDiv(FRACUNIT, xscale);
     if (flip)
     {
@@ -613,10 +692,10 @@ void R_AddSprites(sector_t * sec)
     mobj_t *thing;
     int lightnum;
 
-    if (sec->validcount == validcount)
+    if (sec->spritevalid[RENDERCORE] == validcount)
         return;                 // already added
 
-    sec->validcount = validcount;
+    sec->spritevalid[RENDERCORE] = validcount;
 
     lightnum = (sec->lightlevel >> LIGHTSEGSHIFT) + extralight;
     if (lightnum < 0)
@@ -699,12 +778,12 @@ void R_DrawPSprite(pspdef_t * psp)
         tempangle = 0;
     }
     x1 = (centerxfrac + FixedMul(tx, pspritescale) + tempangle) >> FRACBITS;
-    if (x1 > viewwidth)
+    if (x1 > viewcolend)
         return;                 // off the right side
     tx += spritewidth[lump];
     x2 = ((centerxfrac + FixedMul(tx, pspritescale) +
            tempangle) >> FRACBITS) - 1;
-    if (x2 < 0)
+    if (x2 < viewcolstart)
         return;                 // off the left side
 
 //
@@ -727,8 +806,8 @@ void R_DrawPSprite(pspdef_t * psp)
     {
         vis->texturemid -= PSpriteSY[players[consoleplayer].readyweapon];
     }
-    vis->x1 = x1 < 0 ? 0 : x1;
-    vis->x2 = x2 >= viewwidth ? viewwidth - 1 : x2;
+    vis->x1 = x1 < viewcolstart ? viewcolstart : x1;
+    vis->x2 = x2 >= viewcolend ? viewcolend - 1 : x2;
     vis->scale = pspritescale << detailshift;
     if (flip)
     {
@@ -818,57 +897,106 @@ void R_DrawPlayerSprites(void)
 ========================
 */
 
-vissprite_t vsprsortedhead;
-
 void R_SortVisSprites(void)
 {
-    int i, count;
-    vissprite_t *ds, *best;
-    static vissprite_t unsorted;
-    fixed_t bestscale;
+    vissprite_t **src, **dest, **swap;
+    int count, width, left, mid, right, a, b, i;
 
     count = vissprite_p - vissprites;
-
-    unsorted.next = unsorted.prev = &unsorted;
-    if (!count)
-        return;
-
-    for (ds = vissprites; ds < vissprite_p; ds++)
-    {
-        ds->next = ds + 1;
-        ds->prev = ds - 1;
-    }
-    vissprites[0].prev = &unsorted;
-    unsorted.next = &vissprites[0];
-    (vissprite_p - 1)->next = &unsorted;
-    unsorted.prev = vissprite_p - 1;
+    src = vsprsortspace;
+    dest = vsprsortspace + maxvissprites;
+    for (i = 0; i < count; i++)
+        src[i] = &vissprites[i];
 
 //
-// pull the vissprites out by scale
+// bottom up merge sort by scale, farthest first; it is stable, so equal
+// scales keep the order they were projected in
 //
-    best = 0;                   // shut up the compiler warning
-    vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
-    for (i = 0; i < count; i++)
+    for (width = 1; width < count; width <<= 1)
     {
-        bestscale = INT_MAX;
-        for (ds = unsorted.next; ds != &unsorted; ds = ds->next)
+        for (left = 0; left < count; left += width << 1)
         {
-            if (ds->scale < bestscale)
+            mid = left + width < count ? left + width : count;
+            right = left + (width << 1) < count ? left + (width << 1) : count;
+            a = left;
+            b = mid;
+            i = left;
+            while (a < mid && b < right)
             {
-                bestscale = ds->scale;
-                best = ds;
+                if (src[b]->scale < src[a]->scale)
+                    dest[i++] = src[b++];
+                else
+                    dest[i++] = src[a++];
             }
+            while (a < mid)
+                dest[i++] = src[a++];
+            while (b < right)
+                dest[i++] = src[b++];
         }
-        best->next->prev = best->prev;
-        best->prev->next = best->next;
-        best->next = &vsprsortedhead;
-        best->prev = vsprsortedhead.prev;
-        vsprsortedhead.prev->next = best;
-        vsprsortedhead.prev = best;
+        swap = src;
+        src = dest;
+        dest = swap;
     }
+    vsprsorted = src;
 }
 
 
+/*
+========================
+=
+= R_BinDrawSegs
+=
+= Builds the per-bin sets of drawsegs that can clip sprites
+=
+========================
+*/
+
+static void R_BinDrawSegs(void)
+{
+    drawseg_t *ds;
+    unsigned int bit;
+    int i, b, word;
+
+    memset(dsbins, 0, sizeof(dsbins));
+    for (ds = drawsegs, i = 0; ds < ds_p; ds++, i++)
+    {
+        if (!ds->silhouette && !ds->maskedtexturecol)
+            continue;           // can't cover a sprite
+        word = i >> 5;
+        bit = 1u << (i & 31);
+        for (b = ds->x1 >> DSBINSHIFT; b <= ds->x2 >> DSBINSHIFT; b++)
+            dsbins[b][word] |= bit;
+    }
+}
+
+
+/*
+========================
+=
+= R_TakeLastDrawSeg
+=
+= Returns the highest numbered drawseg left in the set and removes it,
+= or -1 if the set is empty
+=
+========================
+*/
+
+static int R_TakeLastDrawSeg(unsigned int *segbits)
+{
+    int word, bit;
+
+    for (word = DSBITWORDS - 1; word >= 0; word--)
+    {
+        if (segbits[word])
+        {
+            bit = 31 - __builtin_clz(segbits[word]);
+            segbits[word] &= ~(1u << bit);
+            return (word << 5) + bit;
+        }
+    }
+    return -1;
+}
+
 
 /*
 ========================
@@ -882,24 +1010,38 @@ void R_DrawSprite(vissprite_t * spr)
 {
     drawseg_t *ds;
     short clipbot[SCREENWIDTH], cliptop[SCREENWIDTH];
+    unsigned int segbits[DSBITWORDS], bits;
     int x, r1, r2;
     fixed_t scale, lowscale;
     int silhouette;
+    int i, b, word;
 
     for (x = spr->x1; x <= spr->x2; x++)
         clipbot[x] = cliptop[x] = -2;
 
+//
+// collect the drawsegs in the bins the sprite covers
+//
+    for (word = 0; word < DSBITWORDS; word++)
+    {
+        bits = 0;
+        for (b = spr->x1 >> DSBINSHIFT; b <= spr->x2 >> DSBINSHIFT; b++)
+            bits |= dsbins[b][word];
+        segbits[word] = bits;
+    }
+
 //
 // scan drawsegs from end to start for obscuring segs
 // the first drawseg that has a greater scale is the clip seg
 //
-    for (ds = ds_p - 1; ds >= drawsegs; ds--)
+    while ((i = R_TakeLastDrawSeg(segbits)) >= 0)
     {
+        ds = &drawsegs[i];
+
         //
         // determine if the drawseg obscures the sprite
         //
-        if (ds->x1 > spr->x2 || ds->x2 < spr->x1 ||
-            (!ds->silhouette && !ds->maskedtexturecol))
+        if (ds->x1 > spr->x2 || ds->x2 < spr->x1)
             continue;           // doesn't cover sprite
 
         r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
@@ -987,18 +1129,19 @@ void R_DrawSprite(vissprite_t * spr)
 
 void R_DrawMasked(void)
 {
-    vissprite_t *spr;
     drawseg_t *ds;
+    int i, count;
 
     R_SortVisSprites();
 
-    if (vissprite_p > vissprites)
+    count = vissprite_p - vissprites;
+    if (count > 0)
     {
         // draw all vissprites back to front
 
-        for (spr = vsprsortedhead.next; spr != &vsprsortedhead;
-             spr = spr->next)
-            R_DrawSprite(spr);
+        R_BinDrawSegs();
+        for (i = 0; i < count; i++)
+            R_DrawSprite(vsprsorted[i]);
     }
 
 //
@@ -30,6 +30,10 @@
 #include "w_wad.h"
 #include "z_zone.h"
 
+#ifdef USE_PICO_SOUND
+#include "i_picosound.h"
+#endif
+
 /*
 ===============================================================================
 
@@ -534,6 +538,85 @@ void S_Init(void)
     I_PrecacheSounds(S_sfx, NUMSFX);
 }
 
+/*
+===============================================================================
+=
+= S_PrecacheLevel
+=
+= Collects the sounds the current level can play (thing sounds, spawned
+= projectile/effect sounds, ambient sequences and the player's own sounds)
+= and hands them to the low level code so nothing is read from disk mid-game.
+=
+===============================================================================
+*/
+
+static const sfxenum_t alwayssfx[] = {
+    sfx_gldhit, sfx_gntful, sfx_gnthit, sfx_gntpow, sfx_gntact, sfx_gntuse,
+    sfx_phosht, sfx_phohit, sfx_lobsht, sfx_lobhit, sfx_lobpow,
+    sfx_hrnsht, sfx_hrnhit, sfx_hrnpow, sfx_ramphit, sfx_ramrain,
+    sfx_bowsht, sfx_stfhit, sfx_stfpow, sfx_stfcrk,
+    sfx_plroof, sfx_plrpai, sfx_plrdth, sfx_gibdth, sfx_plrwdth, sfx_plrcdth,
+    sfx_itemup, sfx_wpnup, sfx_telept, sfx_doropn, sfx_dorcls, sfx_dormov,
+    sfx_artiup, sfx_switch, sfx_pstart, sfx_pstop, sfx_stnmov,
+    sfx_chicpai, sfx_chicatk, sfx_chicdth, sfx_chicact,
+    sfx_chicpk1, sfx_chicpk2, sfx_chicpk3,
+    sfx_keyup, sfx_ripslop, sfx_burn, sfx_splash, sfx_gloop, sfx_respawn,
+    sfx_chat, sfx_artiuse, sfx_gfrag
+};
+
+void S_PrecacheLevel(void)
+{
+    byte *sfxpresent;
+    thinker_t *th;
+    mobjinfo_t *info;
+    int i;
+
+    sfxpresent = Z_Malloc(NUMSFX, PU_STATIC, NULL);
+    memset(sfxpresent, 0, NUMSFX);
+
+    for (i = 0; i < arrlen(alwayssfx); i++)
+    {
+        sfxpresent[alwayssfx[i]] = 1;
+    }
+
+    // Things that are never placed in a map (missiles, puffs, gibs) are
+    // spawned on demand, so their sounds are always wanted.
+    for (i = 0; i < NUMMOBJTYPES; i++)
+    {
+        if (mobjinfo[i].doomednum == -1)
+        {
+            info = &mobjinfo[i];
+            sfxpresent[info->seesound] = 1;
+            sfxpresent[info->attacksound] = 1;
+            sfxpresent[info->painsound] = 1;
+            sfxpresent[info->deathsound] = 1;
+            sfxpresent[info->activesound] = 1;
+        }
+    }
+
+    for (th = thinkercap.next; th != &thinkercap; th = th->next)
+    {
+        if (th->function == P_MobjThinker)
+        {
+            info = ((mobj_t *) th)->info;
+            sfxpresent[info->seesound] = 1;
+            sfxpresent[info->attacksound] = 1;
+            sfxpresent[info->painsound] = 1;
+            sfxpresent[info->deathsound] = 1;
+            sfxpresent[info->activesound] = 1;
+        }
+    }
+
+    P_MarkAmbientSfx(sfxpresent);
+    sfxpresent[sfx_None] = 0;
+
+#ifdef USE_PICO_SOUND
+    I_PicoSoundPrecacheLevel(S_sfx, sfxpresent, NUMSFX);
+#endif
+
+    Z_Free(sfxpresent);
+}
+
 void S_GetChannelInfo(SoundInfo_t * s)
 {
     int i;
@@ -33,6 +33,7 @@ void S_ResumeSound(void);
 void S_UpdateSounds(mobj_t * listener);
 void S_StartSong(int song, boolean loop);
 void S_Init(void);
+void S_PrecacheLevel(void);
 void S_GetChannelInfo(SoundInfo_t * s);
 void S_SetMaxVolume(boolean fullprocess);
 void S_SetMusicVolume(void);
@@ -117,6 +117,20 @@ int FontBNumBase;
 int spinbooklump;
 int spinflylump;
 
+// Lumps drawn by name every frame, looked up once in SB_Init
+extern char patcharti[][10];
+extern char ammopic[][10];
+static int artilumps[NUMARTIFACTS];
+static int ammolumps[NUMAMMO];
+static int artiboxlump;
+static int useartilump;
+static int lamelump;
+static int god1lump;
+static int god2lump;
+static int ykeylump;
+static int gkeylump;
+static int bkeylump;
+
 // Toggle god mode
 cheatseq_t CheatGodSeq = CHEAT("quicken", 0);
 
@@ -240,6 +254,22 @@ void SB_Init(void)
     playpalette = W_GetNumForName(DEH_String("PLAYPAL"));
     spinbooklump = W_GetNumForName(DEH_String("SPINBK0"));
     spinflylump = W_GetNumForName(DEH_String("SPFLY0"));
+    for (i = 0; i < NUMARTIFACTS; i++)
+    {
+        artilumps[i] = W_GetNumForName(DEH_String(patcharti[i]));
+    }
+    for (i = 0; i < NUMAMMO; i++)
+    {
+        ammolumps[i] = W_GetNumForName(DEH_String(ammopic[i]));
+    }
+    artiboxlump = W_GetNumForName(DEH_String("ARTIBOX"));
+    useartilump = W_GetNumForName(DEH_String("useartia"));
+    lamelump = W_GetNumForName(DEH_String("LAME"));
+    god1lump = W_GetNumForName(DEH_String("GOD1"));
+    god2lump = W_GetNumForName(DEH_String("GOD2"));
+    ykeylump = W_GetNumForName(DEH_String("ykeyicon"));
+    gkeylump = W_GetNumForName(DEH_String("gkeyicon"));
+    bkeylump = W_GetNumForName(DEH_String("bkeyicon"));
 }
 
 //---------------------------------------------------------------------------
@@ -308,7 +338,7 @@ static void DrINumber(signed int val, int x, int y)
     {
         if (val < -9)
         {
-            V_DrawPatch(x + 1, y + 1, W_CacheLumpName(DEH_String("LAME"), PU_CACHE));
+            V_DrawPatch(x + 1, y + 1, W_CacheLumpNum(lamelump, PU_CACHE));
         }
         else
         {
@@ -411,6 +441,7 @@ static void ShadeLine(int x, int y, int height, int shade)
 
     shades = colormaps + 9 * 256 + shade * 2 * 256;
     dest = I_VideoBuffer + y * SCREENWIDTH + x;
+    V_MarkRect(x, y, 1, height);
     while (height--)
     {
         *(dest) = *(shades + *dest);
@@ -567,9 +598,9 @@ void SB_Drawer(void)
             if (players[consoleplayer].cheats & CF_GODMODE)
             {
                 V_DrawPatch(16, ST_Y + 9,
-                            W_CacheLumpName(DEH_String("GOD1"), PU_CACHE));
+                            W_CacheLumpNum(god1lump, PU_CACHE));
                 V_DrawPatch(287, ST_Y + 9,
-                            W_CacheLumpName(DEH_String("GOD2"), PU_CACHE));
+                            W_CacheLumpNum(god2lump, PU_CACHE));
             }
             oldhealth = -1;
         }
@@ -775,7 +806,7 @@ void DrawMainBar(void)
     {
         V_DrawPatch(180, ST_Y + 3, PatchBLACKSQ);
 
-        temp = W_GetNumForName(DEH_String("useartia")) + ArtifactFlash - 1;
+        temp = useartilump + ArtifactFlash - 1;
 
         V_DrawPatch(182, ST_Y + 3, W_CacheLumpNum(temp, PU_CACHE));
         ArtifactFlash--;
@@ -789,8 +820,8 @@ void DrawMainBar(void)
         if (CPlayer->readyArtifact > 0)
         {
             V_DrawPatch(179, ST_Y + 2,
-                        W_CacheLumpName(DEH_String(patcharti[CPlayer->readyArtifact]),
-                                        PU_CACHE));
+                        W_CacheLumpNum(artilumps[CPlayer->readyArtifact],
+                                       PU_CACHE));
             DrSmallNumber(CPlayer->inventory[inv_ptr].count, 201, ST_Y + 24);
         }
         oldarti = CPlayer->readyArtifact;
@@ -839,15 +870,15 @@ void DrawMainBar(void)
     {
         if (CPlayer->keys[key_yellow])
         {
-            V_DrawPatch(153, ST_Y + 6, W_CacheLumpName(DEH_String("ykeyicon"), PU_CACHE));
+            V_DrawPatch(153, ST_Y + 6, W_CacheLumpNum(ykeylump, PU_CACHE));
         }
         if (CPlayer->keys[key_green])
         {
-            V_DrawPatch(153, ST_Y + 14, W_CacheLumpName(DEH_String("gkeyicon"), PU_CACHE));
+            V_DrawPatch(153, ST_Y + 14, W_CacheLumpNum(gkeylump, PU_CACHE));
         }
         if (CPlayer->keys[key_blue])
         {
-            V_DrawPatch(153, ST_Y + 22, W_CacheLumpName(DEH_String("bkeyicon"), PU_CACHE));
+            V_DrawPatch(153, ST_Y + 22, W_CacheLumpNum(bkeylump, PU_CACHE));
         }
         oldkeys = playerkeys;
         UpdateState |= I_STATBAR;
@@ -861,8 +892,8 @@ void DrawMainBar(void)
         {
             DrINumber(temp, 109, ST_Y + 4);
             V_DrawPatch(111, ST_Y + 14,
-                        W_CacheLumpName(DEH_String(ammopic[CPlayer->readyweapon - 1]),
-                                        PU_CACHE));
+                        W_CacheLumpNum(ammolumps[CPlayer->readyweapon - 1],
+                                       PU_CACHE));
         }
         oldammo = temp;
         oldweapon = CPlayer->readyweapon;
@@ -887,7 +918,6 @@ void DrawMainBar(void)
 
 void DrawInventoryBar(void)
 {
-    const char *patch;
     int i;
     int x;
 
@@ -900,9 +930,9 @@ void DrawInventoryBar(void)
         if (CPlayer->inventorySlotNum > x + i
             && CPlayer->inventory[x + i].type != arti_none)
         {
-            patch = DEH_String(patcharti[CPlayer->inventory[x + i].type]);
-
-            V_DrawPatch(50 + i * 31, ST_Y + 2, W_CacheLumpName(patch, PU_CACHE));
+            V_DrawPatch(50 + i * 31, ST_Y + 2,
+                        W_CacheLumpNum(artilumps[CPlayer->inventory[x + i].type],
+                                       PU_CACHE));
             DrSmallNumber(CPlayer->inventory[x + i].count, 69 + i * 31, ST_Y + 24);
         }
     }
@@ -921,7 +951,6 @@ void DrawInventoryBar(void)
 
 void DrawFullScreenStuff(void)
 {
-    const char *patch;
     int i;
     int x;
     int temp;
@@ -951,9 +980,9 @@ void DrawFullScreenStuff(void)
     {
         if (CPlayer->readyArtifact > 0)
         {
-            patch = DEH_String(patcharti[CPlayer->readyArtifact]);
-            V_DrawAltTLPatch(286, ST_Y + 12, W_CacheLumpName(DEH_String("ARTIBOX"), PU_CACHE));
-            V_DrawPatch(286, ST_Y + 12, W_CacheLumpName(patch, PU_CACHE));
+            V_DrawAltTLPatch(286, ST_Y + 12, W_CacheLumpNum(artiboxlump, PU_CACHE));
+            V_DrawPatch(286, ST_Y + 12,
+                        W_CacheLumpNum(artilumps[CPlayer->readyArtifact], PU_CACHE));
             DrSmallNumber(CPlayer->inventory[inv_ptr].count, 307, ST_Y + 34);
         }
     }
@@ -963,13 +992,13 @@ void DrawFullScreenStuff(void)
         for (i = 0; i < 7; i++)
         {
             V_DrawAltTLPatch(50 + i * 31, ST_Y + 10,
-                          W_CacheLumpName(DEH_String("ARTIBOX"), PU_CACHE));
+                          W_CacheLumpNum(artiboxlump, PU_CACHE));
             if (CPlayer->inventorySlotNum > x + i
                 && CPlayer->inventory[x + i].type != arti_none)
             {
-                patch = DEH_String(patcharti[CPlayer->inventory[x + i].type]);
                 V_DrawPatch(50 + i * 31, ST_Y + 10,
-                            W_CacheLumpName(patch, PU_CACHE));
+                            W_CacheLumpNum(artilumps[CPlayer->inventory[x + i].type],
+                                           PU_CACHE));
                 DrSmallNumber(CPlayer->inventory[x + i].count, 69 + i * 31,
                               ST_Y + 32);
             }
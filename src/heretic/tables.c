@@ -61,7 +61,7 @@ int SlopeDiv(unsigned int num, unsigned int den)
     }
 }
 
-const fixed_t finetangent[4096] =
+const fixed_t finetangent_rom[4096] =
 {
     -170910304,-56965752,-34178904,-24413316,-18988036,-15535599,-13145455,-11392683,
     -10052327,-8994149,-8137527,-7429880,-6835455,-6329090,-5892567,-5512368,
@@ -578,7 +578,7 @@ const fixed_t finetangent[4096] =
 };
 
 
-const fixed_t finesine[10240] =
+const fixed_t finesine_rom[10240] =
 {
     25,75,125,175,226,276,326,376,
     427,477,527,578,628,678,728,779,
@@ -1862,9 +1862,9 @@ const fixed_t finesine[10240] =
     65534,65535,65535,65535,65535,65535,65535,65535
 };
 
-const fixed_t *finecosine = &finesine[FINEANGLES/4];
+const fixed_t *finecosine = &finesine_rom[FINEANGLES/4];
 
-const angle_t tantoangle[2049] =
+const angle_t tantoangle_rom[2049] =
 {
     0,333772,667544,1001315,1335086,1668857,2002626,2336395,
     2670163,3003929,3337694,3671457,4005219,4338979,4672736,5006492,
@@ -2126,7 +2126,7 @@ const angle_t tantoangle[2049] =
 };
 
 // Now where did these came from?
-const byte gammatable[5][256] =
+const byte gammatable_rom[5][256] =
 {
     {
         1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,
@@ -2225,3 +2225,14 @@ const byte gammatable[5][256] =
     }
 };
 
+// The tables above stay in flash.  R_InitTables may point these at
+// copies in SRAM.
+
+const fixed_t *finesine = finesine_rom;
+const fixed_t *finetangent = finetangent_rom;
+const angle_t *tantoangle = tantoangle_rom;
+const byte (*gammatable)[256] = gammatable_rom;
+
+#ifdef TABLES_QUARTER_WAVE
+const fixed_t *finesinequarter = finesine_rom;
+#endif
@@ -46,17 +46,63 @@
 #define ANGLETOFINESHIFT	19		
 
 // Effective size is 10240.
-extern const fixed_t finesine[5*FINEANGLES/4];
+extern const fixed_t finesine_rom[5*FINEANGLES/4];
+extern const fixed_t *finesine;
 
 // Re-use data, is just PI/2 pahse shift.
 extern const fixed_t *finecosine;
 
 
 // Effective size is 4096.
-extern const fixed_t finetangent[FINEANGLES/2];
+extern const fixed_t finetangent_rom[FINEANGLES/2];
+extern const fixed_t *finetangent;
 
 // Gamma correction tables.
-extern const byte gammatable[5][256];
+extern const byte gammatable_rom[5][256];
+extern const byte (*gammatable)[256];
+
+// Tables R_InitTables copies to SRAM, as a mask of SRAM_TABLE_* bits.
+
+#define SRAM_TABLE_FINESINE     1
+#define SRAM_TABLE_FINETANGENT  2
+#define SRAM_TABLE_TANTOANGLE   4
+#define SRAM_TABLE_GAMMA        8
+
+#ifndef SRAM_TABLES
+#define SRAM_TABLES (SRAM_TABLE_FINESINE | SRAM_TABLE_FINETANGENT \
+                   | SRAM_TABLE_TANTOANGLE)
+#endif
+
+// Sine and cosine for the renderer's inner loops.  With
+// TABLES_QUARTER_WAVE, only the first quarter of finesine is copied to
+// SRAM and the rest is folded from it.  The folded values can be one
+// off in the last bit, so game code keeps using finesine/finecosine.
+
+#ifdef TABLES_QUARTER_WAVE
+
+extern const fixed_t *finesinequarter;
+
+static inline fixed_t FineSine(unsigned int a)
+{
+    a &= FINEMASK;
+    if (a < FINEANGLES / 4)
+        return finesinequarter[a];
+    if (a < FINEANGLES / 2)
+        return finesinequarter[FINEANGLES / 2 - 1 - a];
+    if (a < 3 * FINEANGLES / 4)
+        return -finesinequarter[a - FINEANGLES / 2];
+    return -finesinequarter[FINEANGLES - 1 - a];
+}
+
+#define FINESINE(a)   FineSine(a)
+#define FINECOSINE(a) FineSine((a) + FINEANGLES / 4)
+
+#else
+
+#define FINESINE(a)   finesine[a]
+#define FINECOSINE(a) finecosine[a]
+
+#endif
 
 // Binary Angle Measument, BAM.
 
@@ -84,7 +130,8 @@ typedef unsigned int angle_t;
 // Effective size is 2049;
 // The +1 size is to handle the case when x==y
 //  without additional checking.
-extern const angle_t tantoangle[SLOPERANGE+1];
+extern const angle_t tantoangle_rom[SLOPERANGE+1];
+extern const angle_t *tantoangle;
 
 
 // Utility function,
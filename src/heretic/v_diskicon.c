@@ -139,6 +139,8 @@ void V_DrawDiskIcon(void)
         CopyRegion(DiskRegionPointer(), SCREENWIDTH,
                    disk_data, LOADING_DISK_W,
                    LOADING_DISK_W, LOADING_DISK_H);
+        V_MarkRect(loading_disk_xoffs, loading_disk_yoffs,
+                   LOADING_DISK_W, LOADING_DISK_H);
         disk_drawn = true;
     }
 
@@ -153,6 +155,8 @@ void V_RestoreDiskBackground(void)
         CopyRegion(DiskRegionPointer(), SCREENWIDTH,
                    saved_background, LOADING_DISK_W,
                    LOADING_DISK_W, LOADING_DISK_H);
+        V_MarkRect(loading_disk_xoffs, loading_disk_yoffs,
+                   LOADING_DISK_W, LOADING_DISK_H);
 
         disk_drawn = false;
     }
@@ -61,10 +61,102 @@ static pixel_t *dest_screen = NULL;
 
 int dirtybox[4]; 
 
+// Columns [dirtyx1[y], dirtyx2[y]) of each row of I_VideoBuffer that have
+// been drawn since the last I_FinishUpdate; empty when dirtyx1 >= dirtyx2.
+
+static short dirtyx1[SCREENHEIGHT];
+static short dirtyx2[SCREENHEIGHT];
+static int dirtytop = SCREENHEIGHT, dirtybottom = 0;
+
+// Bumped whenever something is drawn to I_VideoBuffer, so callers can tell
+// whether the screen still holds what they last drew.
+
+static unsigned int markcount;
+
 // haleyjd 08/28/10: clipping callback function for patches.
 // This is needed for Chocolate Strife, which clips patches to the screen.
 static vpatchclipfunc_t patchclip_callback = NULL;
 
+//
+// V_AddDirtyRect
+// Flag part of I_VideoBuffer for copying out by the next I_FinishUpdate,
+// without counting as a draw.
+//
+void V_AddDirtyRect(int x, int y, int width, int height)
+{
+    int x2, y2;
+
+    x2 = x + width;
+    y2 = y + height;
+
+    if (x < 0)
+        x = 0;
+    if (y < 0)
+        y = 0;
+    if (x2 > SCREENWIDTH)
+        x2 = SCREENWIDTH;
+    if (y2 > SCREENHEIGHT)
+        y2 = SCREENHEIGHT;
+    if (x >= x2 || y >= y2)
+        return;
+
+    if (y < dirtytop)
+        dirtytop = y;
+    if (y2 > dirtybottom)
+        dirtybottom = y2;
+
+    for ( ; y < y2; y++)
+    {
+        if (dirtyx1[y] >= dirtyx2[y])
+        {
+            dirtyx1[y] = x;
+            dirtyx2[y] = x2;
+            continue;
+        }
+        if (x < dirtyx1[y])
+            dirtyx1[y] = x;
+        if (x2 > dirtyx2[y])
+            dirtyx2[y] = x2;
+    }
+}
+
+//
+// V_GetDirtySpan
+// Returns false if row y is clean, otherwise the dirty columns [x1, x2).
+//
+boolean V_GetDirtySpan(int y, int *x1, int *x2)
+{
+    if (y < dirtytop || y >= dirtybottom || dirtyx1[y] >= dirtyx2[y])
+        return false;
+
+    *x1 = dirtyx1[y];
+    *x2 = dirtyx2[y];
+    return true;
+}
+
+boolean V_ScreenDirty(void)
+{
+    return dirtytop < dirtybottom;
+}
+
+void V_ClearDirty(void)
+{
+    int y;
+
+    for (y = dirtytop; y < dirtybottom; y++)
+    {
+        dirtyx1[y] = dirtyx2[y] = 0;
+    }
+
+    dirtytop = SCREENHEIGHT;
+    dirtybottom = 0;
+}
+
+unsigned int V_MarkCount(void)
+{
+    return markcount;
+}
+
 //
 // V_MarkRect 
 // 
@@ -77,6 +169,8 @@ void V_MarkRect(int x, int y, int width, int height)
     {
         M_AddToBox (dirtybox, x, y); 
         M_AddToBox (dirtybox, x + width-1, y + height-1); 
+        V_AddDirtyRect(x, y, width, height);
+        markcount++;
     }
 } 
  
@@ -133,6 +227,254 @@ void V_SetPatchClipCallback(vpatchclipfunc_t func)
     patchclip_callback = func;
 }
 
+//
+// Row-major copies of patches.
+//
+// Drawing a patch by column posts writes down the screen one pixel at a
+// time.  The first time a cached lump is drawn as a patch it is converted
+// to rows of opaque runs, so the drawers below can write along each row
+// instead.  A copy is only used while the zone block's owner (for a lump,
+// its cache pointer) still points at the patch, and the zone is free to
+// purge it.
+//
+
+typedef struct
+{
+    short x;                    // from the left edge of the patch
+    short count;                // pixels that follow, or 0 at the end of
+                                // the row; the next run starts after
+                                // them, rounded up to an even length
+} patchrun_t;
+
+typedef struct
+{
+    short width, height;
+    int rowofs[];               // [height] offsets of the first run of each row
+} patchspans_t;
+
+typedef struct
+{
+    patch_t *patch;
+    void **user;                // zone owner, NULL if the patch has none
+    patchspans_t *spans;        // zone user, NULL once purged
+    unsigned int lastuse;
+} spancache_t;
+
+#define SPANCACHESETS 32
+#define SPANCACHEWAYS 4
+
+static spancache_t spancache[SPANCACHESETS][SPANCACHEWAYS];
+static unsigned int spanclock;
+
+// How V_DrawSpans writes the pixels of a run
+enum
+{
+    SPAN_COPY,
+    SPAN_TINT,                  // V_DrawTLPatch
+    SPAN_ALTTINT,               // V_DrawAltTLPatch
+    SPAN_SHADOW,                // darken only, V_DrawShadowedPatch
+};
+
+static void V_ConvertPatch(spancache_t *entry)
+{
+    patch_t *patch = entry->patch;
+    column_t *column;
+    patchrun_t *run;
+    byte *pixels, *opaque, *source, *dest;
+    int w, h, col, row, x, count, size, tag;
+
+    w = SHORT(patch->width);
+    h = SHORT(patch->height);
+
+    // Keep the patch from being purged by the allocations below
+    tag = Z_GetTag(patch);
+    Z_ChangeTag(patch, PU_STATIC);
+
+    pixels = Z_Malloc(w * h * 2, PU_STATIC, NULL);
+    opaque = pixels + w * h;
+    memset(opaque, 0, w * h);
+
+    for (col = 0; col < w; col++)
+    {
+        column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
+
+        while (column->topdelta != 0xff)
+        {
+            source = (byte *)column + 3;
+            for (row = column->topdelta, count = column->length;
+                 count > 0 && row < h; row++, count--)
+            {
+                pixels[row * w + col] = *source++;
+                opaque[row * w + col] = 1;
+            }
+            column = (column_t *)((byte *)column + column->length + 4);
+        }
+    }
+
+    size = sizeof(patchspans_t) + h * sizeof(int);
+    for (row = 0; row < h; row++)
+    {
+        for (x = 0; x < w; x += count)
+        {
+            for (count = 0; x + count < w && opaque[row * w + x + count];
+                 count++);
+            if (count)
+            {
+                size += sizeof(patchrun_t) + ((count + 1) & ~1);
+            }
+            else
+            {
+                count = 1;
+            }
+        }
+        size += sizeof(patchrun_t);
+    }
+
+    Z_Malloc(size, PU_CACHE, &entry->spans);
+    entry->spans->width = w;
+    entry->spans->height = h;
+    dest = (byte *)&entry->spans->rowofs[h];
+
+    for (row = 0; row < h; row++)
+    {
+        entry->spans->rowofs[row] = dest - (byte *)entry->spans;
+        for (x = 0; x < w; x += count)
+        {
+            for (count = 0; x + count < w && opaque[row * w + x + count];
+                 count++);
+            if (count)
+            {
+                run = (patchrun_t *)dest;
+                run->x = x;
+                run->count = count;
+                memcpy(run + 1, pixels + row * w + x, count);
+                dest += sizeof(patchrun_t) + ((count + 1) & ~1);
+            }
+            else
+            {
+                count = 1;
+            }
+        }
+        run = (patchrun_t *)dest;
+        run->x = 0;
+        run->count = 0;
+        dest += sizeof(patchrun_t);
+    }
+
+    Z_Free(pixels);
+    Z_ChangeTag(patch, tag);
+}
+
+//
+// V_PatchSpans
+// Returns the row-major copy of a patch, or NULL if the patch is not an
+// owned zone block.
+//
+
+static patchspans_t *V_PatchSpans(patch_t *patch)
+{
+    spancache_t *set, *entry, *oldest;
+    int i;
+
+    set = spancache[((uintptr_t)patch >> 4) & (SPANCACHESETS - 1)];
+    entry = NULL;
+    oldest = &set[0];
+    for (i = 0; i < SPANCACHEWAYS; i++)
+    {
+        if (set[i].patch == patch)
+        {
+            entry = &set[i];
+            break;
+        }
+        if (set[i].lastuse < oldest->lastuse)
+        {
+            oldest = &set[i];
+        }
+    }
+
+    // A new patch, or another block now allocated at the same address
+    if (entry == NULL
+     || (entry->user != NULL && *entry->user != patch))
+    {
+        if (entry == NULL)
+        {
+            entry = oldest;
+        }
+        if (entry->spans != NULL)
+        {
+            Z_Free(entry->spans);
+        }
+        entry->patch = patch;
+        entry->user = Z_GetUser(patch);
+    }
+
+    entry->lastuse = ++spanclock;
+    if (entry->user != NULL && entry->spans == NULL)
+    {
+        V_ConvertPatch(entry);
+    }
+
+    return entry->spans;
+}
+
+//
+// V_DrawSpans
+// Draws a row-major patch with its top left corner at desttop.
+//
+
+static void V_DrawSpans(pixel_t *desttop, patchspans_t *spans, int op)
+{
+    patchrun_t *run;
+    byte *source;
+    pixel_t *dest;
+    int y, count;
+
+    for (y = 0; y < spans->height; y++, desttop += SCREENWIDTH)
+    {
+        run = (patchrun_t *)((byte *)spans + spans->rowofs[y]);
+
+        while (run->count != 0)
+        {
+            source = (byte *)(run + 1);
+            dest = desttop + run->x;
+            count = run->count;
+
+            switch (op)
+            {
+                case SPAN_COPY:
+                    memcpy(dest, source, count);
+                    break;
+
+                case SPAN_TINT:
+                    while (count--)
+                    {
+                        *dest = tinttable[*dest + ((*source++) << 8)];
+                        dest++;
+                    }
+                    break;
+
+                case SPAN_ALTTINT:
+                    while (count--)
+                    {
+                        *dest = tinttable[((*dest) << 8) + *source++];
+                        dest++;
+                    }
+                    break;
+
+                case SPAN_SHADOW:
+                    while (count--)
+                    {
+                        *dest = tinttable[((*dest) << 8)];
+                        dest++;
+                    }
+                    break;
+            }
+
+            run = (patchrun_t *)((byte *)(run + 1) + ((run->count + 1) & ~1));
+        }
+    }
+}
+
 //
 // V_DrawPatch
 // Masks a column based masked pic to the screen. 
@@ -146,6 +488,7 @@ void V_DrawPatch(int x, int y, patch_t *patch)
     pixel_t *desttop;
     pixel_t *dest;
     byte *source;
+    patchspans_t *spans;
     int w;
 
     y -= SHORT(patch->topoffset);
@@ -173,6 +516,13 @@ void V_DrawPatch(int x, int y, patch_t *patch)
     col = 0;
     desttop = dest_screen + y * SCREENWIDTH + x;
 
+    spans = V_PatchSpans(patch);
+    if (spans != NULL)
+    {
+        V_DrawSpans(desttop, spans, SPAN_COPY);
+        return;
+    }
+
     w = SHORT(patch->width);
 
     for ( ; col<w ; x++, col++, desttop++)
@@ -284,6 +634,7 @@ void V_DrawTLPatch(int x, int y, patch_t * patch)
     column_t *column;
     pixel_t *desttop, *dest;
     byte *source;
+    patchspans_t *spans;
     int w;
 
     y -= SHORT(patch->topoffset);
@@ -297,9 +648,18 @@ void V_DrawTLPatch(int x, int y, patch_t * patch)
         I_Error("Bad V_DrawTLPatch");
     }
 
+    V_MarkRect(x, y, SHORT(patch->width), SHORT(patch->height));
+
     col = 0;
     desttop = dest_screen + y * SCREENWIDTH + x;
 
+    spans = V_PatchSpans(patch);
+    if (spans != NULL)
+    {
+        V_DrawSpans(desttop, spans, SPAN_TINT);
+        return;
+    }
+
     w = SHORT(patch->width);
     for (; col < w; x++, col++, desttop++)
     {
@@ -346,6 +706,8 @@ void V_DrawXlaPatch(int x, int y, patch_t * patch)
             return;
     }
 
+    V_MarkRect(x, y, SHORT(patch->width), SHORT(patch->height));
+
     col = 0;
     desttop = dest_screen + y * SCREENWIDTH + x;
 
@@ -385,6 +747,7 @@ void V_DrawAltTLPatch(int x, int y, patch_t * patch)
     column_t *column;
     pixel_t *desttop, *dest;
     byte *source;
+    patchspans_t *spans;
     int w;
 
     y -= SHORT(patch->topoffset);
@@ -398,9 +761,18 @@ void V_DrawAltTLPatch(int x, int y, patch_t * patch)
         I_Error("Bad V_DrawAltTLPatch");
     }
 
+    V_MarkRect(x, y, SHORT(patch->width), SHORT(patch->height));
+
     col = 0;
     desttop = dest_screen + y * SCREENWIDTH + x;
 
+    spans = V_PatchSpans(patch);
+    if (spans != NULL)
+    {
+        V_DrawSpans(desttop, spans, SPAN_ALTTINT);
+        return;
+    }
+
     w = SHORT(patch->width);
     for (; col < w; x++, col++, desttop++)
     {
@@ -437,6 +809,7 @@ void V_DrawShadowedPatch(int x, int y, patch_t *patch)
     pixel_t *desttop, *dest;
     byte *source;
     pixel_t *desttop2, *dest2;
+    patchspans_t *spans;
     int w;
 
     y -= SHORT(patch->topoffset);
@@ -450,10 +823,21 @@ void V_DrawShadowedPatch(int x, int y, patch_t *patch)
         I_Error("Bad V_DrawShadowedPatch");
     }
 
+    V_MarkRect(x, y, SHORT(patch->width) + 2, SHORT(patch->height) + 2);
+
     col = 0;
     desttop = dest_screen + y * SCREENWIDTH + x;
     desttop2 = dest_screen + (y + 2) * SCREENWIDTH + x + 2;
 
+    // The shadow is never drawn over the patch, so it can go first
+    spans = V_PatchSpans(patch);
+    if (spans != NULL)
+    {
+        V_DrawSpans(desttop2, spans, SPAN_SHADOW);
+        V_DrawSpans(desttop, spans, SPAN_COPY);
+        return;
+    }
+
     w = SHORT(patch->width);
     for (; col < w; x++, col++, desttop++, desttop2++)
     {
@@ -537,6 +921,8 @@ void V_DrawFilledBox(int x, int y, int w, int h, int c)
     pixel_t *buf, *buf1;
     int x1, y1;
 
+    V_MarkRect(x, y, w, h);
+
     buf = I_VideoBuffer + SCREENWIDTH * y + x;
 
     for (y1 = 0; y1 < h; ++y1)
@@ -557,6 +943,8 @@ void V_DrawHorizLine(int x, int y, int w, int c)
     pixel_t *buf;
     int x1;
 
+    V_MarkRect(x, y, w, 1);
+
     buf = I_VideoBuffer + SCREENWIDTH * y + x;
 
     for (x1 = 0; x1 < w; ++x1)
@@ -570,6 +958,8 @@ void V_DrawVertLine(int x, int y, int h, int c)
     pixel_t *buf;
     int y1;
 
+    V_MarkRect(x, y, 1, h);
+
     buf = I_VideoBuffer + SCREENWIDTH * y + x;
 
     for (y1 = 0; y1 < h; ++y1)
@@ -594,6 +984,8 @@ void V_DrawBox(int x, int y, int w, int h, int c)
  
 void V_DrawRawScreen(pixel_t *raw)
 {
+    V_MarkRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
+
     // Copy 320x200
     memcpy(dest_screen, raw, SCREENWIDTH * 200 * sizeof(*dest_screen));
     // Clear the rest (40 lines) if screen is taller
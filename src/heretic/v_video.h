@@ -68,6 +68,19 @@ void V_DrawBlock(int x, int y, int width, int height, pixel_t *src);
 
 void V_MarkRect(int x, int y, int width, int height);
 
+// Dirty region of I_VideoBuffer still to be copied out by I_FinishUpdate.
+// V_MarkRect adds to it and counts as a draw; V_AddDirtyRect only adds.
+
+void V_AddDirtyRect(int x, int y, int width, int height);
+boolean V_GetDirtySpan(int y, int *x1, int *x2);
+boolean V_ScreenDirty(void);
+void V_ClearDirty(void);
+
+// Number of V_MarkRect calls so far; unchanged means nothing has been
+// drawn to the screen since.
+
+unsigned int V_MarkCount(void);
+
 void V_DrawFilledBox(int x, int y, int w, int h, int c);
 void V_DrawHorizLine(int x, int y, int w, int c);
 void V_DrawVertLine(int x, int y, int h, int c);
@@ -0,0 +1,222 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Unpacking of LZ4 compressed lumps.
+//
+//	The packed data is read from the card in large pieces into the
+//	PSRAM scratch area, and each block is unpacked from there straight
+//	into the lump's buffer, so no second copy of the lump is needed.
+//
+
+#include <string.h>
+
+#include "doomtype.h"
+#include "psram_allocator.h"
+
+#include "w_lz4.h"
+
+// Staging buffer.  Twice the largest block, so a whole block is always
+// in it after a refill.
+#define W_LZ4_STAGE        (2 * W_LZ4_BLOCK)
+
+//
+// W_LZ4Block
+// Unpacks one LZ4 block of srclen bytes into exactly outlen bytes at out.
+// Matches may reach back to base.  Returns false if the block is bad.
+//
+
+static boolean W_LZ4Block(const byte *src, int srclen,
+                          byte *base, byte *out, int outlen)
+{
+    const byte *srcend = src + srclen;
+    byte *outend = out + outlen;
+    unsigned int token, len, offset, n;
+    const byte *match;
+
+    while (src < srcend)
+    {
+        token = *src++;
+
+        // Literals
+
+        len = token >> 4;
+        if (len == 15)
+        {
+            do
+            {
+                if (src >= srcend)
+                {
+                    return false;
+                }
+                n = *src++;
+                len += n;
+            } while (n == 255);
+        }
+
+        if (len > (unsigned int) (srcend - src)
+         || len > (unsigned int) (outend - out))
+        {
+            return false;
+        }
+
+        memcpy(out, src, len);
+        src += len;
+        out += len;
+
+        // The last sequence has no match
+
+        if (src == srcend)
+        {
+            break;
+        }
+
+        if (srcend - src < 2)
+        {
+            return false;
+        }
+
+        offset = src[0] | (src[1] << 8);
+        src += 2;
+
+        len = (token & 15) + 4;
+        if ((token & 15) == 15)
+        {
+            do
+            {
+                if (src >= srcend)
+                {
+                    return false;
+                }
+                n = *src++;
+                len += n;
+            } while (n == 255);
+        }
+
+        if (offset == 0 || offset > (unsigned int) (out - base)
+         || len > (unsigned int) (outend - out))
+        {
+            return false;
+        }
+
+        match = out - offset;
+
+        if (offset >= len)
+        {
+            memcpy(out, match, len);
+            out += len;
+        }
+        else
+        {
+            // Overlapping: repeats the last offset bytes
+
+            while (len-- > 0)
+            {
+                *out++ = *match++;
+            }
+        }
+    }
+
+    return out == outend;
+}
+
+//
+// W_ReadPacked
+//
+
+int W_ReadPacked(wad_file_t *wad, unsigned int offset, int packedsize,
+                 void *dest, int size)
+{
+    byte *stage;
+    byte *out;
+    unsigned int header;
+    int have, start, left, n;
+    int blocklen, outlen, done;
+
+    stage = psram_get_scratch_1(W_LZ4_STAGE);
+    out = dest;
+    have = 0;
+    start = 0;
+    left = packedsize;
+    done = 0;
+
+    while (done < size)
+    {
+        // Refill when the next block isn't all in the buffer
+
+        blocklen = -1;
+        if (have >= 4)
+        {
+            header = stage[start] | (stage[start + 1] << 8)
+                   | (stage[start + 2] << 16)
+                   | ((unsigned int) stage[start + 3] << 24);
+            blocklen = header & ~W_LZ4_STORED;
+
+            if (blocklen > W_LZ4_BLOCK)
+            {
+                break;
+            }
+        }
+
+        if (blocklen < 0 || have < 4 + blocklen)
+        {
+            if (left == 0)
+            {
+                break;
+            }
+
+            memmove(stage, stage + start, have);
+            start = 0;
+
+            n = W_LZ4_STAGE - have;
+            if (n > left)
+            {
+                n = left;
+            }
+
+            if ((int) W_Read(wad, offset, stage + have, n) < n)
+            {
+                break;
+            }
+
+            offset += n;
+            left -= n;
+            have += n;
+            continue;
+        }
+
+        outlen = size - done;
+        if (outlen > W_LZ4_BLOCK)
+        {
+            outlen = W_LZ4_BLOCK;
+        }
+
+        if (header & W_LZ4_STORED)
+        {
+            if (blocklen != outlen)
+            {
+                break;
+            }
+            memcpy(out + done, stage + start + 4, outlen);
+        }
+        else if (!W_LZ4Block(stage + start + 4, blocklen, out,
+                             out + done, outlen))
+        {
+            break;
+        }
+
+        done += outlen;
+        start += 4 + blocklen;
+        have -= 4 + blocklen;
+    }
+
+    return done;
+}
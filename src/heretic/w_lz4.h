@@ -0,0 +1,38 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Compressed lumps in "ZWAD" files written by tools/wadlz4.py.
+//
+//	A ZWAD has the usual WAD header, and directory entries with the
+//	packed size between the position and the unpacked size.  A packed
+//	size of zero means the lump is stored as is.  A packed lump is a
+//	run of LZ4 blocks, each holding W_LZ4_BLOCK bytes of the lump (the
+//	last one the remainder) after a 32-bit little-endian header with
+//	its length.  Bit 31 of the header marks a block stored as is.
+//	Matches may reach back into earlier blocks of the same lump.
+//
+
+#ifndef W_LZ4_H
+#define W_LZ4_H
+
+#include "w_file.h"
+
+#define W_LZ4_BLOCK        0x8000
+#define W_LZ4_STORED       0x80000000u
+
+// Reads and unpacks a lump into dest, which must hold size bytes.
+// Returns the number of bytes unpacked, short if the data is bad.
+
+int W_ReadPacked(wad_file_t *wad, unsigned int offset, int packedsize,
+                 void *dest, int size);
+
+#endif
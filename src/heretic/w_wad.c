@@ -26,18 +26,36 @@
 
 #include "doomtype.h"
 
+#include "deh_str.h"
 #include "i_swap.h"
 #include "i_system.h"
 #include "i_video.h"
 #include "m_misc.h"
+#include "psram_allocator.h"
 #include "v_diskicon.h"
 #include "z_zone.h"
 
+#include "w_lz4.h"
 #include "w_wad.h"
 
+#ifdef SPLIT_RENDER
+#include "pico/mutex.h"
+
+// Both render cores load lumps while a frame is split between them
+auto_init_recursive_mutex(cachelock);
+
+// While a frame is split, every lump either core uses stays at PU_STATIC,
+// so that a load on one core can't purge a lump the other is drawing
+// from.  They are chained through pinnext until W_UnpinLumps, which
+// gives each the tag it was last cached or released with.
+static boolean pinlumps;
+static lumpinfo_t pinnedend;
+static lumpinfo_t *pinnedlumps = &pinnedend;
+#endif
+
 typedef PACKED_STRUCT (
 {
-    // Should be "IWAD" or "PWAD".
+    // Should be "IWAD", "PWAD" or "ZWAD".
     char		identification[4];
     int			numlumps;
     int			infotableofs;
@@ -51,6 +69,16 @@ typedef PACKED_STRUCT (
     char		name[8];
 }) filelump_t;
 
+// Directory entry of a ZWAD; see w_lz4.h.
+
+typedef PACKED_STRUCT (
+{
+    int			filepos;
+    int			packedsize;
+    int			size;
+    char		name[8];
+}) zfilelump_t;
+
 //
 // GLOBALS
 //
@@ -59,8 +87,29 @@ typedef PACKED_STRUCT (
 lumpinfo_t **lumpinfo;
 unsigned int numlumps = 0;
 
-// Hash table for fast lookups
-static lumpindex_t *lumphash;
+// Compact directory for fast lookups: each lump name as an uppercase
+// 64-bit key next to the lump's offset and size, and hash chains over
+// lump numbers.  Kept in SRAM when it fits, so a probe is one key compare
+// and finding a lump's length or place in the file doesn't touch lumpinfo.
+
+typedef struct
+{
+    uint64_t key;
+    int position;
+    int size;
+} lumpentry_t;
+
+static lumpentry_t *lumpdir;
+static uint16_t *lumpchain;
+static uint16_t *lumphash;
+static unsigned int lumphashbits;
+static boolean lumpdir_in_zone;
+
+#define LUMPDIR_END 0xffff
+
+// Bumped whenever lump numbers may change; lumphandle_t re-resolves
+// when its generation no longer matches.
+static unsigned int lumpgeneration = 1;
 
 // Variables for the reload hack: filename of the PWAD to reload, and the
 // lumps from WADs before the reload file, so we can resent numlumps and
@@ -87,6 +136,46 @@ unsigned int W_LumpNameHash(const char *s)
     return result;
 }
 
+// Uppercase lump name packed into a 64-bit key, zero padded.
+static uint64_t W_LumpNameKey(const char *s)
+{
+    uint64_t key = 0;
+    unsigned int i;
+
+    for (i=0; i < 8 && s[i] != '\0'; ++i)
+    {
+        key |= (uint64_t) (byte) toupper(s[i]) << (i * 8);
+    }
+
+    return key;
+}
+
+static unsigned int W_LumpKeyHash(uint64_t key)
+{
+    return (unsigned int) ((key * 0x9e3779b97f4a7c15ULL) >> (64 - lumphashbits));
+}
+
+static void W_FreeDirectory(void)
+{
+    if (lumpdir == NULL)
+    {
+        return;
+    }
+
+    if (lumpdir_in_zone)
+    {
+        Z_Free(lumpdir);
+    }
+    else
+    {
+        free(lumpdir);
+    }
+
+    lumpdir = NULL;
+    lumpchain = NULL;
+    lumphash = NULL;
+}
+
 //
 // LUMP BASED ROUTINES.
 //
@@ -109,6 +198,7 @@ wad_file_t *W_AddFile (const char *filename)
     int startlump;
     filelump_t *fileinfo;
     filelump_t *filerover;
+    zfilelump_t *zfileinfo = NULL;
     lumpinfo_t *filelumps;
     int numfilelumps;
 
@@ -164,7 +254,13 @@ wad_file_t *W_AddFile (const char *filename)
 	// WAD file
         W_Read(wad_file, 0, &header, sizeof(header));
 
-	if (strncmp(header.identification,"IWAD",4))
+	if (!strncmp(header.identification,"ZWAD",4))
+	{
+	    // Compressed by tools/wadlz4.py
+	    zfileinfo = Z_Malloc(LONG(header.numlumps) * sizeof(zfilelump_t),
+	                         PU_STATIC, 0);
+	}
+	else if (strncmp(header.identification,"IWAD",4))
 	{
 	    // Homebrew levels?
 	    if (strncmp(header.identification,"PWAD",4))
@@ -189,11 +285,32 @@ wad_file_t *W_AddFile (const char *filename)
          }
 
 	header.infotableofs = LONG(header.infotableofs);
-	length = header.numlumps*sizeof(filelump_t);
-	fileinfo = Z_Malloc(length, PU_STATIC, 0);
-
-        W_Read(wad_file, header.infotableofs, fileinfo, length);
 	numfilelumps = header.numlumps;
+
+	if (zfileinfo != NULL)
+	{
+	    zfilelump_t *zfilerover;
+
+	    length = header.numlumps*sizeof(zfilelump_t);
+	    W_Read(wad_file, header.infotableofs, zfileinfo, length);
+
+	    // Unpacked sizes stand in for the ordinary directory; the
+	    // packed sizes are picked up again below.
+	    fileinfo = Z_Malloc(header.numlumps*sizeof(filelump_t), PU_STATIC, 0);
+	    for (i = 0, zfilerover = zfileinfo; i < numfilelumps; ++i, ++zfilerover)
+	    {
+	        fileinfo[i].filepos = zfilerover->filepos;
+	        fileinfo[i].size = zfilerover->size;
+	        memcpy(fileinfo[i].name, zfilerover->name, 8);
+	    }
+	}
+	else
+	{
+	    length = header.numlumps*sizeof(filelump_t);
+	    fileinfo = Z_Malloc(length, PU_STATIC, 0);
+
+	    W_Read(wad_file, header.infotableofs, fileinfo, length);
+	}
     }
 
     // Increase size of numlumps array to accomodate the new file.
@@ -215,6 +332,8 @@ wad_file_t *W_AddFile (const char *filename)
         lump_p->wad_file = wad_file;
         lump_p->position = LONG(filerover->filepos);
         lump_p->size = LONG(filerover->size);
+        lump_p->packedsize =
+            zfileinfo != NULL ? LONG(zfileinfo[i - startlump].packedsize) : 0;
         lump_p->cache = NULL;
         strncpy(lump_p->name, filerover->name, 8);
         lumpinfo[i] = lump_p;
@@ -223,13 +342,14 @@ wad_file_t *W_AddFile (const char *filename)
     }
 
     Z_Free(fileinfo);
-
-    if (lumphash != NULL)
+    if (zfileinfo != NULL)
     {
-        Z_Free(lumphash);
-        lumphash = NULL;
+        Z_Free(zfileinfo);
     }
 
+    W_FreeDirectory();
+    ++lumpgeneration;
+
     // If this is the reload file, we need to save some details about the
     // file so that we can close it later on when we do a reload.
     if (reloadname)
@@ -266,17 +386,19 @@ lumpindex_t W_CheckNumForName(const char *name)
 
     if (lumphash != NULL)
     {
-        int hash;
+        uint64_t key;
+        unsigned int j;
 
         // We do! Excellent.
 
-        hash = W_LumpNameHash(name) % numlumps;
+        key = W_LumpNameKey(name);
 
-        for (i = lumphash[hash]; i != -1; i = lumpinfo[i]->next)
+        for (j = lumphash[W_LumpKeyHash(key)]; j != LUMPDIR_END;
+             j = lumpchain[j])
         {
-            if (!strncasecmp(lumpinfo[i]->name, name, 8))
+            if (lumpdir[j].key == key)
             {
-                return i;
+                return j;
             }
         }
     }
@@ -333,6 +455,11 @@ int W_LumpLength(lumpindex_t lump)
 	I_Error ("W_LumpLength: %i >= numlumps", lump);
     }
 
+    if (lumpdir != NULL)
+    {
+        return lumpdir[lump].size;
+    }
+
     return lumpinfo[lump]->size;
 }
 
@@ -346,6 +473,7 @@ int W_LumpLength(lumpindex_t lump)
 void W_ReadLump(lumpindex_t lump, void *dest)
 {
     int c;
+    int position, size;
     lumpinfo_t *l;
 
     if (lump >= numlumps)
@@ -355,14 +483,37 @@ void W_ReadLump(lumpindex_t lump, void *dest)
 
     l = lumpinfo[lump];
 
-    V_BeginRead(l->size);
+    if (lumpdir != NULL)
+    {
+        position = lumpdir[lump].position;
+        size = lumpdir[lump].size;
+    }
+    else
+    {
+        position = l->position;
+        size = l->size;
+    }
 
-    c = W_Read(l->wad_file, l->position, dest, l->size);
+    V_BeginRead(size);
 
-    if (c < l->size)
+    if (l->packedsize != 0)
+    {
+        // The unpacker stages through a scratch buffer shared by both
+        // render cores.
+        W_LockCache();
+        c = W_ReadPacked(l->wad_file, position, l->packedsize,
+                         dest, size);
+        W_UnlockCache();
+    }
+    else
+    {
+        c = W_Read(l->wad_file, position, dest, size);
+    }
+
+    if (c < size)
     {
         I_Error("W_ReadLump: only read %i of %i on lump %i",
-                c, l->size, lump);
+                c, size, lump);
     }
 }
 
@@ -381,6 +532,85 @@ void W_ReadLump(lumpindex_t lump, void *dest)
 // when no longer needed (do not use Z_ChangeTag).
 //
 
+//
+// W_LockCache
+//
+// Keeps the other render core from loading or purging lumps while the
+// lump cache is being changed.  Nests, and does nothing unless built
+// with SPLIT_RENDER.
+//
+
+void W_LockCache(void)
+{
+#ifdef SPLIT_RENDER
+    recursive_mutex_enter_blocking(&cachelock);
+#endif
+}
+
+void W_UnlockCache(void)
+{
+#ifdef SPLIT_RENDER
+    recursive_mutex_exit(&cachelock);
+#endif
+}
+
+#ifdef SPLIT_RENDER
+static void W_PinLump(lumpinfo_t *lump, int tag)
+{
+    lump->pintag = tag;
+    Z_ChangeTag(lump->cache, PU_STATIC);
+
+    if (lump->pinnext == NULL)
+    {
+        lump->pinnext = pinnedlumps;
+        pinnedlumps = lump;
+    }
+}
+#endif
+
+//
+// W_PinLumps
+//
+// Holds every lump cached or released from now until W_UnpinLumps, while
+// both render cores draw.  Does nothing unless built with SPLIT_RENDER.
+//
+
+void W_PinLumps(void)
+{
+#ifdef SPLIT_RENDER
+    pinlumps = true;
+#endif
+}
+
+//
+// W_UnpinLumps
+//
+// Returns the lumps held since W_PinLumps to the tags they would have
+// had without pinning.  Only called once the other core has finished
+// with them.
+//
+
+void W_UnpinLumps(void)
+{
+#ifdef SPLIT_RENDER
+    lumpinfo_t *lump;
+
+    pinlumps = false;
+
+    while (pinnedlumps != &pinnedend)
+    {
+        lump = pinnedlumps;
+        pinnedlumps = lump->pinnext;
+        lump->pinnext = NULL;
+
+        if (lump->cache != NULL)
+        {
+            Z_ChangeTag(lump->cache, lump->pintag);
+        }
+    }
+#endif
+}
+
 void *W_CacheLumpNum(lumpindex_t lumpnum, int tag)
 {
     byte *result;
@@ -393,12 +623,14 @@ void *W_CacheLumpNum(lumpindex_t lumpnum, int tag)
 
     lump = lumpinfo[lumpnum];
 
+    W_LockCache();
+
     // Get the pointer to return.  If the lump is in a memory-mapped
     // file, we can just return a pointer to within the memory-mapped
     // region.  If the lump is in an ordinary file, we may already
     // have it cached; otherwise, load it into memory.
 
-    if (lump->wad_file->mapped != NULL)
+    if (lump->wad_file->mapped != NULL && lump->packedsize == 0)
     {
         // Memory mapped file, return from the mmapped region.
 
@@ -419,6 +651,15 @@ void *W_CacheLumpNum(lumpindex_t lumpnum, int tag)
 	W_ReadLump (lumpnum, lump->cache);
         result = lump->cache;
     }
+
+#ifdef SPLIT_RENDER
+    if (pinlumps && lump->cache != NULL)
+    {
+        W_PinLump(lump, tag);
+    }
+#endif
+
+    W_UnlockCache();
 	
     return result;
 }
@@ -433,6 +674,30 @@ void *W_CacheLumpName(const char *name, int tag)
     return W_CacheLumpNum(W_GetNumForName(name), tag);
 }
 
+//
+// W_GetNumForHandle
+// Resolves the handle's name the first time, and again only after the
+// WAD directory has changed.
+//
+lumpindex_t W_GetNumForHandle(lumphandle_t *handle)
+{
+    if (handle->generation != lumpgeneration)
+    {
+        handle->lumpnum = W_GetNumForName(DEH_String(handle->name));
+        handle->generation = lumpgeneration;
+    }
+
+    return handle->lumpnum;
+}
+
+//
+// W_CacheLumpHandle
+//
+void *W_CacheLumpHandle(lumphandle_t *handle, int tag)
+{
+    return W_CacheLumpNum(W_GetNumForHandle(handle), tag);
+}
+
 // 
 // Release a lump back to the cache, so that it can be reused later 
 // without having to read from disk again, or alternatively, discarded
@@ -454,13 +719,25 @@ void W_ReleaseLumpNum(lumpindex_t lumpnum)
 
     lump = lumpinfo[lumpnum];
 
-    if (lump->wad_file->mapped != NULL)
+    if (lump->wad_file->mapped != NULL && lump->packedsize == 0)
     {
         // Memory-mapped file, so nothing needs to be done here.
     }
     else
     {
-        Z_ChangeTag(lump->cache, PU_CACHE);
+        W_LockCache();
+#ifdef SPLIT_RENDER
+        if (pinlumps)
+        {
+            // The other core may still be drawing from it
+            W_PinLump(lump, PU_CACHE);
+        }
+        else
+#endif
+        {
+            Z_ChangeTag(lump->cache, PU_CACHE);
+        }
+        W_UnlockCache();
     }
 }
 
@@ -540,32 +817,57 @@ void W_Profile (void)
 void W_GenerateHashTable(void)
 {
     lumpindex_t i;
+    unsigned int hashsize;
+    size_t size;
 
     // Free the old hash table, if there is one:
-    if (lumphash != NULL)
-    {
-        Z_Free(lumphash);
-    }
+    W_FreeDirectory();
+    ++lumpgeneration;
 
     // Generate hash table
     if (numlumps > 0)
     {
-        lumphash = Z_Malloc(sizeof(lumpindex_t) * numlumps, PU_STATIC, NULL);
+        if (numlumps >= LUMPDIR_END)
+        {
+            I_Error("W_GenerateHashTable: too many lumps (%u)", numlumps);
+        }
 
-        for (i = 0; i < numlumps; ++i)
+        // About two lumps per chain
+        lumphashbits = 1;
+        while ((1u << lumphashbits) < numlumps / 2)
+        {
+            ++lumphashbits;
+        }
+        hashsize = 1u << lumphashbits;
+
+        size = numlumps * (sizeof(*lumpdir) + sizeof(*lumpchain))
+             + hashsize * sizeof(*lumphash);
+        lumpdir = sram_try_malloc(size);
+        lumpdir_in_zone = lumpdir == NULL;
+        if (lumpdir_in_zone)
+        {
+            lumpdir = Z_Malloc(size, PU_STATIC, NULL);
+        }
+        lumpchain = (uint16_t *) (lumpdir + numlumps);
+        lumphash = lumpchain + numlumps;
+
+        for (i = 0; i < hashsize; ++i)
         {
-            lumphash[i] = -1;
+            lumphash[i] = LUMPDIR_END;
         }
 
         for (i = 0; i < numlumps; ++i)
         {
             unsigned int hash;
 
-            hash = W_LumpNameHash(lumpinfo[i]->name) % numlumps;
+            lumpdir[i].key = W_LumpNameKey(lumpinfo[i]->name);
+            lumpdir[i].position = lumpinfo[i]->position;
+            lumpdir[i].size = lumpinfo[i]->size;
+            hash = W_LumpKeyHash(lumpdir[i].key);
 
-            // Hook into the hash table
+            // Hook into the hash table; later lumps are found first
 
-            lumpinfo[i]->next = lumphash[hash];
+            lumpchain[i] = lumphash[hash];
             lumphash[hash] = i;
         }
     }
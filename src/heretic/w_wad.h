@@ -43,13 +43,33 @@ struct lumpinfo_s
     wad_file_t *wad_file;
     int		position;
     int		size;
+    int		packedsize;	// 0 unless LZ4 packed in a ZWAD
     void       *cache;
-
-    // Used for hash table lookups
-    lumpindex_t next;
+#ifdef SPLIT_RENDER
+    lumpinfo_t *pinnext;	// held until the split frame ends
+    int		pintag;		// tag to restore when unpinned
+#endif
 };
 
 
+//
+// A lump looked up by name once, then by number until the WAD directory
+// changes.  The name is passed through DEH_String when it is resolved.
+// Use for lumps drawn every frame, e.g.
+//   static lumphandle_t paused = LUMPHANDLE("PAUSED");
+//   V_DrawPatch(x, y, W_CacheLumpHandle(&paused, PU_CACHE));
+//
+
+typedef struct
+{
+    const char *name;
+    lumpindex_t lumpnum;
+    unsigned int generation;
+} lumphandle_t;
+
+#define LUMPHANDLE(name) { (name), -1, 0 }
+
+
 extern lumpinfo_t **lumpinfo;
 extern unsigned int numlumps;
 
@@ -63,8 +83,15 @@ int W_LumpLength(lumpindex_t lump);
 void W_ReadLump(lumpindex_t lump, void *dest);
 
 void *W_CacheLumpNum(lumpindex_t lump, int tag);
+void W_LockCache(void);
+void W_UnlockCache(void);
+void W_PinLumps(void);
+void W_UnpinLumps(void);
 void *W_CacheLumpName(const char *name, int tag);
 
+lumpindex_t W_GetNumForHandle(lumphandle_t *handle);
+void *W_CacheLumpHandle(lumphandle_t *handle, int tag);
+
 void W_GenerateHashTable(void);
 
 extern unsigned int W_LumpNameHash(const char *s);
@@ -487,6 +487,42 @@ void Z_ChangeUser(void *ptr, void **user)
     *user = ptr;
 }
 
+//
+// Z_GetTag
+//
+int Z_GetTag(void *ptr)
+{
+    memblock_t*	block;
+
+    block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
+
+    if (block->id != ZONEID)
+    {
+        I_Error("Z_GetTag: block without a ZONEID!");
+    }
+
+    return block->tag;
+}
+
+//
+// Z_GetUser
+// Returns the owner of a block, or NULL if it has none or ptr is not
+// a zone block.
+//
+void **Z_GetUser(void *ptr)
+{
+    memblock_t*	block;
+
+    block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
+
+    if (block->id != ZONEID)
+    {
+        return NULL;
+    }
+
+    return block->user;
+}
+
 
 //
 // Z_FreeMemory
@@ -17,6 +17,10 @@
 // Increased from 1024 to handle 1421 samples per buffer at 49716 Hz
 #define SAMPLE_BUF_SIZE 2048
 
+#if EMU8950_RATE_SHIFT && !EMU8950_SLOT_RENDER
+#error EMU8950_RATE_SHIFT is only supported by the EMU8950_SLOT_RENDER renderer
+#endif
+
 #ifndef INLINE
 #if defined(_MSC_VER)
 #define INLINE __inline
@@ -556,9 +560,9 @@ static void commit_slot_update(OPL_SLOT *slot, uint8_t notesel) {
             SLOT_MEMBER(slot, eg_rate_h) = min(15, p_rate + (SLOT_MEMBER(slot, rks) >> 2));
             SLOT_MEMBER(slot, eg_rate_l) = SLOT_MEMBER(slot, rks) & 3;
             if (SLOT_MEMBER(slot, eg_state) == ATTACK) {
-                SLOT_MEMBER(slot, eg_shift) = (0 < SLOT_MEMBER(slot, eg_rate_h) && SLOT_MEMBER(slot, eg_rate_h) < 12) ? (12 - SLOT_MEMBER(slot, eg_rate_h)) : 0;
+                SLOT_MEMBER(slot, eg_shift) = (0 < SLOT_MEMBER(slot, eg_rate_h)) ? EG_SHIFT_FOR_RATE(SLOT_MEMBER(slot, eg_rate_h)) : 0;
             } else {
-                SLOT_MEMBER(slot, eg_shift) = (SLOT_MEMBER(slot, eg_rate_h) < 12) ? (12 - SLOT_MEMBER(slot, eg_rate_h)) : 0;
+                SLOT_MEMBER(slot, eg_shift) = EG_SHIFT_FOR_RATE(SLOT_MEMBER(slot, eg_rate_h));
             }
         }
     }
@@ -586,9 +590,9 @@ static void commit_slot_update_eg_only(OPL_SLOT *slot, uint8_t notesel) {
         SLOT_MEMBER(slot, eg_rate_h) = min(15, p_rate + (SLOT_MEMBER(slot, rks) >> 2));
         SLOT_MEMBER(slot, eg_rate_l) = SLOT_MEMBER(slot, rks) & 3;
         if (SLOT_MEMBER(slot, eg_state) == ATTACK) {
-            SLOT_MEMBER(slot, eg_shift) = (0 < SLOT_MEMBER(slot, eg_rate_h) && SLOT_MEMBER(slot, eg_rate_h) < 12) ? (12 - SLOT_MEMBER(slot, eg_rate_h)) : 0;
+            SLOT_MEMBER(slot, eg_shift) = (0 < SLOT_MEMBER(slot, eg_rate_h)) ? EG_SHIFT_FOR_RATE(SLOT_MEMBER(slot, eg_rate_h)) : 0;
         } else {
-            SLOT_MEMBER(slot, eg_shift) = (SLOT_MEMBER(slot, eg_rate_h) < 12) ? (12 - SLOT_MEMBER(slot, eg_rate_h)) : 0;
+            SLOT_MEMBER(slot, eg_shift) = EG_SHIFT_FOR_RATE(SLOT_MEMBER(slot, eg_rate_h));
         }
     }
     slot->update_requests = 0;
@@ -1341,7 +1345,7 @@ void OPL_reset(OPL *opl) {
 //        opl->reg[i] = 0;
 //    }
     opl->reg[0x04] = 0x18; // MASK_EOS | MASK_BUF_RDY
-    opl->pm_dphase = PM_DPHASE;
+    opl->pm_dphase = PM_DPHASE << EMU8950_RATE_SHIFT;
 
 //    for (i = 0; i < 15; i++) {
 //        opl->ch_out[i] = 0;
@@ -1748,8 +1752,8 @@ void OPL_calc_buffer_linear(OPL *opl, int32_t *buffer, uint32_t nsamples) {
     for(uint32_t s = 0; s<nsamples; s++) {
         // generate amplitude modulation same for all channels
         // need am_phase and lfo_am
-        opl->am_phase_index++;
-        if (opl->am_phase_index == sizeof(am_table)) opl->am_phase_index = 0;
+        opl->am_phase_index += 1u << EMU8950_RATE_SHIFT;
+        if (opl->am_phase_index >= sizeof(am_table)) opl->am_phase_index -= sizeof(am_table);
         // todo this is a candidate for remove simply because it is not super noticeable without
 
 #if EMU8950_SLOT_RENDER
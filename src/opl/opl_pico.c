@@ -186,6 +186,66 @@ extern uint8_t restart_song_state;
 // Temp buffer for OPL 32-bit to 16-bit conversion (moved to file scope to avoid any stack issues)
 #if USE_EMU8950_OPL
 static int32_t opl_temp_buffer[2048 * 2]; // stereo, max samples
+
+// The emulator may run at PICO_SOUND_SAMPLE_FREQ >> EMU8950_RATE_SHIFT; its
+// output is then linearly interpolated back up to the I2S rate. The state
+// carries across calls: the next output sample lies opl_interp_pos / 2^shift
+// of the way from opl_interp_prev to opl_interp_next.
+#define OPL_RATE_FACTOR (1u << EMU8950_RATE_SHIFT)
+#if EMU8950_RATE_SHIFT
+static int32_t opl_interp_prev, opl_interp_next;
+static uint opl_interp_pos = OPL_RATE_FACTOR;
+#endif
+
+// OPL output is quiet; amplify by 8x for audible output
+#define OPL_OUTPUT_SHIFT 3
+
+static inline uint32_t opl_output_frame(int32_t sample)
+{
+    sample <<= OPL_OUTPUT_SHIFT;
+    if (sample > INT16_MAX) sample = INT16_MAX;
+    else if (sample < INT16_MIN) sample = INT16_MIN;
+    // mono duplicated to both channels
+    return (uint16_t)sample * 0x10001u;
+}
+
+// Renders nsamples stereo frames at the I2S rate straight into out,
+// applying upsampling, gain and saturation in one pass.
+static void OPL_Pico_Render(uint32_t *out, unsigned int nsamples)
+{
+#if EMU8950_RATE_SHIFT
+    // frames left before another emulator sample is needed
+    unsigned int avail = OPL_RATE_FACTOR - opl_interp_pos;
+    unsigned int needed = nsamples > avail ?
+            (nsamples - avail + OPL_RATE_FACTOR - 1) >> EMU8950_RATE_SHIFT : 0;
+    if (needed) {
+        OPL_calc_buffer_stereo(emu8950_opl, opl_temp_buffer, needed);
+    }
+
+    // OPL_calc_buffer_stereo packs the same sample in both halves
+    const int32_t *src = opl_temp_buffer;
+    int32_t prev = opl_interp_prev;
+    int32_t next = opl_interp_next;
+    uint pos = opl_interp_pos;
+    for (unsigned int i = 0; i < nsamples; i++) {
+        if (pos == OPL_RATE_FACTOR) {
+            prev = next;
+            next = (int16_t)*src++;
+            pos = 0;
+        }
+        out[i] = opl_output_frame(prev + (((next - prev) * (int32_t)pos) >> EMU8950_RATE_SHIFT));
+        pos++;
+    }
+    opl_interp_prev = prev;
+    opl_interp_next = next;
+    opl_interp_pos = pos;
+#else
+    OPL_calc_buffer_stereo(emu8950_opl, opl_temp_buffer, nsamples);
+    for (unsigned int i = 0; i < nsamples; i++) {
+        out[i] = opl_output_frame((int16_t)opl_temp_buffer[i]);
+    }
+#endif
+}
 #endif
 
 void OPL_Pico_Mix_callback(audio_buffer_t *audio_buffer)
@@ -255,23 +315,7 @@ void OPL_Pico_Mix_callback(audio_buffer_t *audio_buffer)
                     nsamples = buffer_samples - filled;
                 }
                 
-                // OPL outputs 32-bit samples but audio buffer expects 16-bit
-                // Use file-scope buffer to avoid any stack/corruption issues
-                OPL_calc_buffer_stereo(emu8950_opl, opl_temp_buffer, nsamples);
-                
-                // Convert 32-bit packed stereo to 16-bit separate L/R channels
-                // OPL_calc_buffer_stereo writes: buffer[i] = (left << 16) | right
-                // where left and right are the same (mono duplicated to stereo)
-                int16_t *buffer_start = (int16_t *)audio_buffer->buffer->bytes;
-                int16_t *sndptr16 = buffer_start + (filled * 2); // filled samples × 2 channels
-                for (unsigned int i = 0; i < nsamples; i++) {
-                    // Each opl_temp_buffer[i] contains both channels packed
-                    int32_t packed = opl_temp_buffer[i];
-                    int16_t left = (int16_t)(packed >> 16);
-                    int16_t right = (int16_t)(packed & 0xFFFF);
-                    sndptr16[i * 2] = left;
-                    sndptr16[i * 2 + 1] = right;
-                }
+                OPL_Pico_Render((uint32_t *)audio_buffer->buffer->bytes + filled, nsamples);
             }
 #else
             int16_t *sndptr = (int16_t *) (audio_buffer->buffer->bytes + filled * 4);
@@ -291,7 +335,7 @@ void OPL_Pico_Mix_callback(audio_buffer_t *audio_buffer)
             AdvanceTime(nsamples);
         }
         audio_buffer->sample_count = audio_buffer->max_sample_count;
-#if !USE_WOODY_OPL
+#if !USE_WOODY_OPL && !USE_EMU8950_OPL
         // Amplify by 8x for audible output
         int16_t *samples = (int16_t *)audio_buffer->buffer->bytes;
         for(uint i=0;i<audio_buffer->sample_count * 2; i++) {
@@ -343,6 +387,10 @@ static int OPL_Pico_Init(unsigned int port_base)
         adlib_init(mixing_freq);
 #elif USE_EMU8950_OPL
         emu8950_opl = OPL_new(3579552, PICO_SOUND_SAMPLE_FREQ); // todo check rate
+#if EMU8950_RATE_SHIFT
+        opl_interp_prev = opl_interp_next = 0;
+        opl_interp_pos = OPL_RATE_FACTOR;
+#endif
 #else
         OPL3_Reset(&opl_chip, PICO_SOUND_SAMPLE_FREQ);
         opl_opl3mode = 0;
@@ -290,9 +290,9 @@ template <int EG_STATE> void commit_slot_update_eg_only(SLOT_RENDER *slot) {
         slot->eg_rate_h = std::min(15, p_rate + (slot->rks >> 2));
         slot->eg_rate_l = slot->rks & 3;
         if (EG_STATE == ATTACK) {
-            slot->eg_shift = (0 < slot->eg_rate_h && slot->eg_rate_h < 12) ? (12 - slot->eg_rate_h) : 0;
+            slot->eg_shift = (0 < slot->eg_rate_h) ? EG_SHIFT_FOR_RATE(slot->eg_rate_h) : 0;
         } else {
-            slot->eg_shift = (slot->eg_rate_h < 12) ? (12 - slot->eg_rate_h) : 0;
+            slot->eg_shift = EG_SHIFT_FOR_RATE(slot->eg_rate_h);
         }
     }
 }
@@ -303,7 +303,7 @@ template<bool PM> uint32_t advance_phase(SLOT_RENDER *slot, uint32_t &pm_phase)
 #if !PICO_ON_DEVICE
         // todo if we do this with interpolator, then we can just skip the if
         // todo PM_DPHASE == 512
-        pm_phase = (pm_phase + PM_DPHASE) & (PM_DP_WIDTH - 1);
+        pm_phase = (pm_phase + (PM_DPHASE << EMU8950_RATE_SHIFT)) & (PM_DP_WIDTH - 1);
         pm = slot->efix_pm_table[pm_phase >> (PM_DP_BITS - PM_PG_BITS)];
 #else
         interp1->add_raw[1] = 1;
@@ -400,7 +400,7 @@ extern "C" uint32_t test_slot_asm(SLOT_RENDER *slot, uint32_t nsamples, uint32_t
 
 template <int F_NUM, typename F> uint32_t slot_envelope_loop(F&& fn, SLOT_RENDER *slot, uint32_t nsamples, uint32_t eg_counter, uint32_t pm_phase) {
     // factored out as it is constant per call
-    slot->efix_pg_phase_multiplier = ml_table[slot->patch->ML] << slot->blk;
+    slot->efix_pg_phase_multiplier = ml_table[slot->patch->ML] << (slot->blk + EMU8950_RATE_SHIFT);
     uint32_t efix_pg_pm_x_fnum3ff = (slot->fnum & 0x3ff) * slot->efix_pg_phase_multiplier;
     // pm = pm_table[(slot->fnum >> 7) & 7][pm_phase >> (PM_DP_BITS - PM_PG_BITS)];
     // pm >>= (slot->pm_mode ? 0 : 1);
@@ -441,11 +441,13 @@ template <int F_NUM, typename F> uint32_t slot_envelope_loop(F&& fn, SLOT_RENDER
     static_assert(PM_DPHASE == 1, ""); // better for everyone!
     // pm_phase = (pm_phase + PM_DPHASE) & (PM_DP_WIDTH - 1);
     // pm = slot->efix_pm_table[pm_phase >> (PM_DP_BITS - PM_PG_BITS)];
-    interp_config_set_shift(&c, PM_DP_BITS - PM_PG_BITS);
+    // the accumulator steps by 1 per sample, so at reduced rates count in
+    // units of PM_DPHASE << EMU8950_RATE_SHIFT and shift less
+    interp_config_set_shift(&c, PM_DP_BITS - PM_PG_BITS - EMU8950_RATE_SHIFT);
     interp_config_set_mask(&c, 0, PM_PG_BITS - 1);
     interp_set_config(interp1, 1, &c);
     interp1->base[1] = (uintptr_t)efix_pm_table;
-    interp1->accum[1] = pm_phase;
+    interp1->accum[1] = pm_phase >> EMU8950_RATE_SHIFT;
     // we lookup in the lfo_am_buffer_lsl3 at inter0->base[2] + sample_ptr_in_mod_buffer / 2 for mod
     //                                  or at inter0->base[2] + sample_ptr_in_buffer / 4
     if (F_NUM <8) {
@@ -34,6 +34,17 @@ extern "C" {
 #define PM_DP_WIDTH (1 << PM_DP_BITS)
 #define PM_DPHASE (PM_DP_WIDTH / (1024 * 8))
 
+/* render below the chip rate: every output sample advances the chip by
+ * 1 << EMU8950_RATE_SHIFT samples (0 = 49716Hz, 1 = half, 2 = quarter rate) */
+#ifndef EMU8950_RATE_SHIFT
+#define EMU8950_RATE_SHIFT 0
+#endif
+
+/* eg counter shift for a given eg_rate_h, sped up to match EMU8950_RATE_SHIFT
+ * (rates that already update every sample cannot go any faster) */
+#define EG_SHIFT_FOR_RATE(rate_h) \
+    ((rate_h) + EMU8950_RATE_SHIFT < 12 ? 12 - EMU8950_RATE_SHIFT - (rate_h) : 0)
+
 /* voice data */
 typedef struct __OPL_PATCH {
 #if !EMU8950_NO_TLL
@@ -62,6 +62,11 @@
 #define SOUND_LOW_PASS 1
 #endif
 
+// Verify the DSP mixing kernel against the C reference and time it at boot
+#ifndef PICO_SOUND_MIX_SELFTEST
+#define PICO_SOUND_MIX_SELFTEST 0
+#endif
+
 // Enable increased I2S drive strength for cleaner signal
 #ifndef INCREASE_I2S_DRIVE_STRENGTH
 #define INCREASE_I2S_DRIVE_STRENGTH 1
@@ -145,6 +150,27 @@ static const int index_table[] = {
 };
 // =============================
 
+// Sound effects are kept fully decoded-ready in memory so that starting a
+// sound never touches the SD card: a per-level contiguous bank is built by
+// I_PicoSoundPrecacheLevel, and anything missed is loaded once on first use
+// (counted in sfx_sd_loads) and kept for the rest of the session.
+#ifndef SOUND_BANK_MAX_SIZE
+#define SOUND_BANK_MAX_SIZE (768 * 1024)
+#endif
+
+typedef struct
+{
+    const uint8_t *data;        // payload: signed 8-bit PCM or ADPCM blocks
+    uint32_t length;
+    uint16_t sample_freq;
+    boolean is_adpcm;
+    boolean in_bank;            // lives in sfx_bank_base (PU_LEVEL)
+} sfx_bank_entry_t;
+
+static sfx_bank_entry_t sfx_bank[NUMSFX];
+static uint8_t *sfx_bank_base;
+static unsigned int sfx_sd_loads;
+
 static void (*music_generator)(audio_buffer_t *buffer);
 
 static boolean sound_initialized = false;
@@ -281,44 +307,26 @@ static void decompress_buffer(pico_channel_t *channel) {
             int block_size = MIN((int)sizeof(channel->decompressed), channel->data_end - channel->data);
             channel->decompressed_size = block_size;
             assert(channel->decompressed_size && channel->decompressed_size <= sizeof(channel->decompressed));
-            const uint8_t *src = channel->data;
-            for (int i = 0; i < block_size; ++i) {
-                channel->decompressed[i] = (int8_t)src[i];
-            }
+            memcpy(channel->decompressed, channel->data, block_size);
             channel->data += block_size;
         }
     }
 }
 
-static boolean init_channel_for_sfx(pico_channel_t *ch, const sfxinfo_t *sfxinfo, int pitch)
+// Parses a sound lump already read into memory at lump and fills in the
+// bank entry. The payload is used in place: PCM lumps in the ROM WAD are
+// already the signed 8-bit samples the mixer consumes.
+static boolean prepare_sfx_entry(sfx_bank_entry_t *entry, uint8_t *lump, int lumplen)
 {
-    const sfxinfo_t *base = base_sfxinfo(sfxinfo);
-    int lumpnum = base->lumpnum;
-    if (lumpnum < 0)
-    {
-        char namebuf[9];
-        GetSfxLumpName(base, namebuf, sizeof(namebuf));
-        lumpnum = W_GetNumForName(namebuf);
-        if (lumpnum < 0)
-        {
-            return false;
-        }
-    }
-    int lumplen = W_LumpLength(lumpnum);
-
-    const uint8_t *data = W_CacheLumpNum(lumpnum, PU_STATIC); // we don't track because we assume in ROWAD anyway
-
     if (lumplen < 8)
     {
         return false;
     }
 
-    uint16_t format = read_le16(data);
+    uint16_t format = read_le16(lump);
     boolean is_adpcm = format == 0x8003;
-    boolean is_signed_pcm = format == 0x0003;
-    ch->is_adpcm = is_adpcm;
 
-    uint32_t declared_length = read_le32(data + 4);
+    uint32_t declared_length = read_le32(lump + 4);
     int payload_length = lumplen - 8;
     if (declared_length && declared_length < (uint32_t)payload_length) {
         payload_length = (int)declared_length;
@@ -327,20 +335,77 @@ static boolean init_channel_for_sfx(pico_channel_t *ch, const sfxinfo_t *sfxinfo
         return false;
     }
 
-    ch->data = data + 8;
-    ch->data_end = ch->data + payload_length;
+    entry->data = lump + 8;
+    entry->length = payload_length;
+    entry->sample_freq = read_le16(lump + 2);
+    entry->is_adpcm = is_adpcm;
+    return true;
+}
+
+static int sfx_lump_num(const sfxinfo_t *base)
+{
+    if (base->lumpnum >= 0)
+    {
+        return base->lumpnum;
+    }
+
+    char namebuf[9];
+    GetSfxLumpName(base, namebuf, sizeof(namebuf));
+    return W_CheckNumForName(namebuf);
+}
+
+// Slow path for sounds the level precache did not predict: read the lump
+// from the WAD once and keep it for the rest of the session.
+static const sfx_bank_entry_t *load_sfx_entry(const sfxinfo_t *base)
+{
+    sfx_bank_entry_t *entry = &sfx_bank[base - S_sfx];
+    int lumpnum = sfx_lump_num(base);
+    if (lumpnum < 0)
+    {
+        return NULL;
+    }
 
-    uint32_t sample_freq = read_le16(data + 2);
+    int lumplen = W_LumpLength(lumpnum);
+    uint8_t *lump = Z_Malloc(lumplen, PU_STATIC, NULL);
+    W_ReadLump(lumpnum, lump);
+    sfx_sd_loads++;
 
-    /*
-    static int header_logs = 0;
-    if (header_logs < 12) {
-        printf("I_Pico_StartSound: header %s format=%04x adpcm=%d signed_pcm=%d rate=%u declared=%u payload=%d\n",
-               DEH_String(base->name), format, is_adpcm, is_signed_pcm, (unsigned)sample_freq,
-               (unsigned)declared_length, payload_length);
-        header_logs++;
+    if (!prepare_sfx_entry(entry, lump, lumplen))
+    {
+        Z_Free(lump);
+        entry->data = NULL;
+        return NULL;
     }
-    */
+    entry->in_bank = false;
+    return entry;
+}
+
+static inline const sfx_bank_entry_t *lookup_sfx_entry(const sfxinfo_t *base)
+{
+    const sfx_bank_entry_t *entry = &sfx_bank[base - S_sfx];
+    // the bank is PU_LEVEL; once Z_FreeTags releases it sfx_bank_base is
+    // cleared, so stale entries fall through to a reload
+    if (entry->data && (!entry->in_bank || sfx_bank_base))
+    {
+        return entry;
+    }
+    return load_sfx_entry(base);
+}
+
+static boolean init_channel_for_sfx(pico_channel_t *ch, const sfxinfo_t *sfxinfo, int pitch)
+{
+    const sfx_bank_entry_t *entry = lookup_sfx_entry(base_sfxinfo(sfxinfo));
+    if (!entry)
+    {
+        return false;
+    }
+
+    ch->is_adpcm = entry->is_adpcm;
+    ch->data = entry->data;
+    ch->data_end = ch->data + entry->length;
+
+    uint32_t sample_freq = entry->sample_freq;
+
     if (pitch == NORM_PITCH)
         ch->step = sample_freq * 65536 / PICO_SOUND_SAMPLE_FREQ;
     else
@@ -382,7 +447,101 @@ static void GetSfxLumpName(const sfxinfo_t *sfx, char *buf, size_t buf_len)
 
 static void I_Pico_PrecacheSounds(sfxinfo_t *sounds, int num_sounds)
 {
-    // no-op
+    // Called once from S_Init before any level is known; the real work
+    // happens per level in I_PicoSoundPrecacheLevel.
+    memset(sfx_bank, 0, sizeof(sfx_bank));
+    sfx_bank_base = NULL;
+    sfx_sd_loads = 0;
+}
+
+void I_PicoSoundPrecacheLevel(sfxinfo_t *sounds, const byte *present, int num_sounds)
+{
+    int lumpnums[NUMSFX];
+    byte wanted[NUMSFX];
+    uint32_t total = 0;
+
+    if (!sound_initialized)
+    {
+        return;
+    }
+
+    sfx_sd_loads = 0;
+
+    // nothing may still be reading the old bank
+    for (int i = 0; i < NUM_SOUND_CHANNELS; i++)
+    {
+        stop_channel(i);
+    }
+    for (int i = 0; i < NUMSFX; i++)
+    {
+        if (sfx_bank[i].in_bank)
+        {
+            sfx_bank[i].data = NULL;
+            sfx_bank[i].in_bank = false;
+        }
+    }
+    if (sfx_bank_base)
+    {
+        Z_Free(sfx_bank_base);
+    }
+
+    // linked sounds share their target's entry, so collect each base once
+    num_sounds = MIN(num_sounds, NUMSFX);
+    memset(wanted, 0, sizeof(wanted));
+    for (int i = 0; i < num_sounds; i++)
+    {
+        if (present[i])
+        {
+            wanted[base_sfxinfo(&sounds[i]) - S_sfx] = 1;
+        }
+    }
+
+    for (int i = 0; i < NUMSFX; i++)
+    {
+        lumpnums[i] = -1;
+        if (!wanted[i] || sfx_bank[i].data)
+        {
+            continue;
+        }
+        int lumpnum = sfx_lump_num(&S_sfx[i]);
+        if (lumpnum < 0)
+        {
+            continue;
+        }
+        uint32_t size = (W_LumpLength(lumpnum) + 3) & ~3u;
+        if (total + size > SOUND_BANK_MAX_SIZE)
+        {
+            continue;
+        }
+        lumpnums[i] = lumpnum;
+        total += size;
+    }
+
+    if (total)
+    {
+        Z_Malloc(total, PU_LEVEL, (void **)&sfx_bank_base);
+    }
+
+    uint8_t *dest = sfx_bank_base;
+    for (int i = 0; i < NUMSFX; i++)
+    {
+        if (lumpnums[i] < 0)
+        {
+            continue;
+        }
+        int lumplen = W_LumpLength(lumpnums[i]);
+        W_ReadLump(lumpnums[i], dest);
+        if (prepare_sfx_entry(&sfx_bank[i], dest, lumplen))
+        {
+            sfx_bank[i].in_bank = true;
+        }
+        dest += (lumplen + 3) & ~3;
+    }
+}
+
+unsigned int I_PicoSoundSdLoads(void)
+{
+    return sfx_sd_loads;
 }
 
 static int I_Pico_GetSfxLumpNum(sfxinfo_t *sfx)
@@ -453,59 +612,182 @@ static boolean I_Pico_SoundIsPlaying(int channel)
     return is_channel_playing(channel);
 }
 
-static void mix_audio_buffer(audio_buffer_t *buffer)
+// ====== SFX MIXING KERNEL =====
+//
+// All playing channels are summed into a 32-bit stereo accumulator in one
+// pass per pair of channels: the two channels' current samples are packed
+// into one word and SMLAD multiplies both against the packed left (then
+// right) volumes, adding into the accumulator. A final pass saturates the
+// accumulator to 16 bits (SSAT + PKHBT) and adds it to the music already
+// in the buffer with QADD16, so there is a single clamp per output sample
+// rather than one per channel.
+//
+// The C versions below are the reference for the DSP instructions and are
+// what non-ARM builds use.
+
+static inline int32_t mix_smlad_ref(uint32_t x, uint32_t y, int32_t acc)
 {
-    if (music_generator) {
-        music_generator(buffer);
-    } else {
-        memset(buffer->buffer->bytes, 0, buffer->buffer->size);
-    }
+    return acc + (int16_t)x * (int16_t)y + (int16_t)(x >> 16) * (int16_t)(y >> 16);
+}
 
-    int active_channels = 0;
-    for(int ch=0; ch < NUM_SOUND_CHANNELS; ch++) {
-        if (!is_channel_playing(ch)) {
-            continue;
-        }
-        active_channels++;
-        pico_channel_t *channel = &channels[ch];
-        assert(channel->decompressed_size);
-        int voll = channel->left;
-        int volr = channel->right;
-        uint offset_end = channel->decompressed_size * 65536;
-        assert(channel->offset < offset_end);
-        int16_t *samples = (int16_t *)buffer->buffer->bytes;
+static inline uint32_t mix_pack_sat_ref(int32_t l, int32_t r)
+{
+    return (uint16_t)clamp_s16(l) | ((uint32_t)(uint16_t)clamp_s16(r) << 16);
+}
+
+static inline uint32_t mix_qadd16_ref(uint32_t x, uint32_t y)
+{
+    int16_t lo = clamp_s16((int16_t)x + (int16_t)y);
+    int16_t hi = clamp_s16((int16_t)(x >> 16) + (int16_t)(y >> 16));
+    return (uint16_t)lo | ((uint32_t)(uint16_t)hi << 16);
+}
+
+#if PICO_ON_DEVICE && defined(__ARM_FEATURE_DSP)
+#define MIX_USE_DSP 1
+
+static __force_inline int32_t mix_smlad(uint32_t x, uint32_t y, int32_t acc)
+{
+    int32_t r;
+    __asm ("smlad %0, %1, %2, %3" : "=r" (r) : "r" (x), "r" (y), "r" (acc));
+    return r;
+}
+
+static __force_inline uint32_t mix_pack_sat(int32_t l, int32_t r)
+{
+    uint32_t out;
+    __asm ("ssat %0, #16, %0" : "+r" (l));
+    __asm ("ssat %0, #16, %0" : "+r" (r));
+    __asm ("pkhbt %0, %1, %2, lsl #16" : "=r" (out) : "r" (l), "r" (r));
+    return out;
+}
+
+static __force_inline uint32_t mix_qadd16(uint32_t x, uint32_t y)
+{
+    uint32_t r;
+    __asm ("qadd16 %0, %1, %2" : "=r" (r) : "r" (x), "r" (y));
+    return r;
+}
+#else
+#define MIX_USE_DSP 0
+#define mix_smlad mix_smlad_ref
+#define mix_pack_sat mix_pack_sat_ref
+#define mix_qadd16 mix_qadd16_ref
+#endif
+
+typedef struct
+{
+    pico_channel_t *channel;
+    uint offset_end;
+#if SOUND_LOW_PASS
+    int sample;
+    int alpha256;
+#endif
+} mix_voice_t;
+
+// stand-in partner for the last channel when an odd number are playing
+static pico_channel_t mix_silent_channel;
+static int32_t mix_acc[PICO_SOUND_BUFFER_SAMPLES * 2];
+
+static void mix_voice_init(mix_voice_t *v, pico_channel_t *channel)
+{
+    v->channel = channel;
+    v->offset_end = channel->decompressed_size * 65536;
+    assert(!channel->decompressed_size || channel->offset < v->offset_end);
 #if SOUND_LOW_PASS
-        int alpha256 = channel->alpha256;
-        int beta256 = 256 - alpha256;
-        int sample = channel->decompressed[channel->offset >> 16];
+    v->alpha256 = channel->alpha256;
+    v->sample = channel->decompressed_size ? channel->decompressed[channel->offset >> 16] : 0;
 #endif
-        for(int s=0;s<buffer->max_sample_count;s++) {
-#if !SOUND_LOW_PASS
-            int sample = channel->decompressed[channel->offset >> 16];
+}
+
+// Returns the channel's next output sample, or 0 once it has finished.
+static __force_inline int mix_voice_next(mix_voice_t *v)
+{
+    pico_channel_t *channel = v->channel;
+    if (!channel->decompressed_size) {
+        return 0;
+    }
+#if SOUND_LOW_PASS
+    int sample = ((256 - v->alpha256) * v->sample + v->alpha256 * channel->decompressed[channel->offset >> 16]) / 256;
+    v->sample = sample;
 #else
-            sample = (beta256 * sample + alpha256 * channel->decompressed[channel->offset >> 16]) / 256;
+    int sample = channel->decompressed[channel->offset >> 16];
 #endif
-            int32_t mixed_left = samples[0];
-            mixed_left += sample * voll;
-            samples[0] = clamp_s16(mixed_left);
-
-            int32_t mixed_right = samples[1];
-            mixed_right += sample * volr;
-            samples[1] = clamp_s16(mixed_right);
-
-            samples += 2;
-            channel->offset += channel->step;
-            if (channel->offset >= offset_end) {
-                channel->offset -= offset_end;
-                decompress_buffer(channel);
-                offset_end = channel->decompressed_size * 65536;
-                if (channel->offset >= offset_end) {
-                    stop_channel(ch);
-                    break;
-                }
-            }
+    channel->offset += channel->step;
+    if (channel->offset >= v->offset_end) {
+        channel->offset -= v->offset_end;
+        decompress_buffer(channel);
+        v->offset_end = channel->decompressed_size * 65536;
+        if (channel->offset >= v->offset_end) {
+            channel->decompressed_size = 0; // stop_channel
+        }
+    }
+    return sample;
+}
+
+static void __not_in_flash_func(mix_voice_pair)(int32_t *acc, int frames, mix_voice_t *a, mix_voice_t *b, boolean accumulate)
+{
+    uint32_t vols_l = a->channel->left | ((uint32_t)b->channel->left << 16);
+    uint32_t vols_r = a->channel->right | ((uint32_t)b->channel->right << 16);
+
+    if (accumulate) {
+        for (int s = 0; s < frames; s++) {
+            uint32_t packed = (uint16_t)mix_voice_next(a) | ((uint32_t)mix_voice_next(b) << 16);
+            acc[0] = mix_smlad(packed, vols_l, acc[0]);
+            acc[1] = mix_smlad(packed, vols_r, acc[1]);
+            acc += 2;
+        }
+    } else {
+        for (int s = 0; s < frames; s++) {
+            uint32_t packed = (uint16_t)mix_voice_next(a) | ((uint32_t)mix_voice_next(b) << 16);
+            acc[0] = mix_smlad(packed, vols_l, 0);
+            acc[1] = mix_smlad(packed, vols_r, 0);
+            acc += 2;
+        }
+    }
+}
+
+// Mixes the playing channels in chans[] on top of the S16 stereo frames in
+// out; returns the number of channels that were active.
+static int mix_channels(uint32_t *out, int frames, pico_channel_t *chans, int num_chans)
+{
+    mix_voice_t voices[NUM_SOUND_CHANNELS + 1];
+    int n = 0;
+
+    for (int ch = 0; ch < num_chans && n < NUM_SOUND_CHANNELS; ch++) {
+        if (chans[ch].decompressed_size) {
+            mix_voice_init(&voices[n++], &chans[ch]);
         }
     }
+    if (!n) {
+        return 0;
+    }
+    if (n & 1) {
+        mix_voice_init(&voices[n], &mix_silent_channel);
+    }
+
+    for (int i = 0; i < n; i += 2) {
+        mix_voice_pair(mix_acc, frames, &voices[i], &voices[i + 1], i != 0);
+    }
+
+    const int32_t *acc = mix_acc;
+    for (int s = 0; s < frames; s++) {
+        out[s] = mix_qadd16(out[s], mix_pack_sat(acc[0], acc[1]));
+        acc += 2;
+    }
+    return n;
+}
+
+static void mix_audio_buffer(audio_buffer_t *buffer)
+{
+    if (music_generator) {
+        music_generator(buffer);
+    } else {
+        memset(buffer->buffer->bytes, 0, buffer->buffer->size);
+    }
+
+    assert(buffer->max_sample_count <= PICO_SOUND_BUFFER_SAMPLES);
+    int active_channels = mix_channels((uint32_t *)buffer->buffer->bytes, buffer->max_sample_count,
+                                       channels, NUM_SOUND_CHANNELS);
 
     buffer->sample_count = buffer->max_sample_count;
     if (fade_state == FS_SILENT) {
@@ -590,6 +872,58 @@ static void I_Pico_ShutdownSound(void)
     sound_initialized = false;
 }
 
+#if PICO_SOUND_MIX_SELFTEST
+// Checks the DSP primitives against their C reference and times the mixer
+// with an increasing number of synthetic channels.
+static void mix_selftest(void)
+{
+    uint32_t seed = 0x12345678;
+    int mismatches = 0;
+
+    for (int i = 0; i < 100000; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        uint32_t x = seed;
+        seed = seed * 1664525u + 1013904223u;
+        uint32_t y = seed;
+        int32_t l = (int32_t)x >> 12, r = (int32_t)y >> 12;
+        if (mix_smlad(x & 0x00ff00ffu, y & 0x00ff00ffu, l) != mix_smlad_ref(x & 0x00ff00ffu, y & 0x00ff00ffu, l) ||
+            mix_pack_sat(l, r) != mix_pack_sat_ref(l, r) ||
+            mix_qadd16(x, y) != mix_qadd16_ref(x, y)) {
+            mismatches++;
+        }
+    }
+    printf("mix_selftest: %s path, %d mismatches vs C reference\n",
+           MIX_USE_DSP ? "DSP" : "C", mismatches);
+
+    static pico_channel_t bench[NUM_SOUND_CHANNELS];
+    static uint32_t out[PICO_SOUND_BUFFER_SAMPLES];
+    for (int n = 0; n <= NUM_SOUND_CHANNELS; n += 4) {
+        for (int ch = 0; ch < NUM_SOUND_CHANNELS; ch++) {
+            pico_channel_t *c = &bench[ch];
+            memset(c, 0, sizeof(*c));
+            if (ch < n) {
+                for (int i = 0; i < ADPCM_SAMPLES_PER_BLOCK_SIZE; i++) {
+                    c->decompressed[i] = (int8_t)((i * (ch + 3)) & 0xff);
+                }
+                // data == data_end: play the one block, then stop
+                c->decompressed_size = ADPCM_SAMPLES_PER_BLOCK_SIZE;
+                c->step = 11025 * 65536 / PICO_SOUND_SAMPLE_FREQ;
+                c->left = 32;
+                c->right = 48;
+#if SOUND_LOW_PASS
+                c->alpha256 = 128;
+#endif
+            }
+        }
+        memset(out, 0, sizeof(out));
+        uint32_t t0 = time_us_32();
+        mix_channels(out, PICO_SOUND_BUFFER_SAMPLES, bench, NUM_SOUND_CHANNELS);
+        printf("mix_selftest: %2d channels: %lu us per buffer\n",
+               n, (unsigned long)(time_us_32() - t0));
+    }
+}
+#endif
+
 static boolean I_Pico_InitSound(boolean _use_sfx_prefix)
 {
     use_sfx_prefix = _use_sfx_prefix;
@@ -637,6 +971,10 @@ static boolean I_Pico_InitSound(boolean _use_sfx_prefix)
     printf("I_Pico_InitSound: enabling I2S\n");
     audio_i2s_set_enabled(true);
 
+#if PICO_SOUND_MIX_SELFTEST
+    mix_selftest();
+#endif
+
     sound_initialized = true;
     printf("I_Pico_InitSound: initialization complete\n");
     return true;
@@ -21,6 +21,8 @@
 #define __I_PICO_SOUND__
 
 #include "pico.h"
+#include "doomtype.h"
+#include "i_sound.h"
 typedef struct audio_buffer audio_buffer_t;
 
 #if USE_EMU8950_OPL
@@ -35,6 +37,10 @@ typedef struct audio_buffer audio_buffer_t;
 #define NUM_SOUND_CHANNELS 8
 #endif
 
+// Build the level's sound bank from the sounds flagged in present
+void I_PicoSoundPrecacheLevel(sfxinfo_t *sounds, const byte *present, int num_sounds);
+// Number of sounds read from the WAD on demand since the last level start
+unsigned int I_PicoSoundSdLoads(void);
 void I_PicoSoundSetMusicGenerator(void (*generator)(audio_buffer_t *buffer));
 bool I_PicoSoundIsInitialized(void);
 void I_PicoSoundFade(bool in);
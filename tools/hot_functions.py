@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+# Profile-guided placement of hot functions into SRAM.
+#
+#   rank   Read murmheretic.map and a PC profile, and write the list of
+#          the hottest functions that fit in a byte budget.
+#   place  Rename .text.<func> to .time_critical.<func> in object files,
+#          so the SDK linker script copies those functions to SRAM. The
+#          compiler's output is kept next to each object as <obj>.orig
+#          and the renames are always made from it, so a changed or
+#          empty list leaves no earlier renames behind.
+#   check  Report from murmheretic.map where the listed functions ended up.
+#
+# The profile is either pcprof.bin written by a PC_PROFILE build (raw
+# little-endian 32-bit PCs), or a text file of "<count> <function>" lines,
+# e.g. from a host build run under perf or gprof.
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import argparse
+import bisect
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+
+FLASH_SECTION = ".text."
+SRAM_SECTION = ".time_critical."
+
+# Input section lines of a GNU ld map. Long names put the address and
+# size on the following line.
+SECTION_RE = re.compile(r"^ (\.text\.\S+|\.time_critical\.\S+)"
+                        r"(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S+))?\s*$")
+ADDR_RE = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S+)\s*$")
+
+
+def read_map(path):
+    """Return [(addr, size, section, object)] for function input sections."""
+    sections = []
+    pending = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            if pending is not None:
+                m = ADDR_RE.match(line)
+                if m:
+                    sections.append((int(m.group(1), 16), int(m.group(2), 16),
+                                     pending, m.group(3)))
+                pending = None
+                continue
+            m = SECTION_RE.match(line)
+            if not m:
+                continue
+            if m.group(2) is None:
+                pending = m.group(1)
+            else:
+                sections.append((int(m.group(2), 16), int(m.group(3), 16),
+                                 m.group(1), m.group(4)))
+    # Sections discarded by --gc-sections are listed at address 0
+    sections = [s for s in sections if s[0] != 0 and s[1] != 0]
+    sections.sort()
+    return sections
+
+
+def function_name(section):
+    for prefix in (SRAM_SECTION, FLASH_SECTION):
+        if section.startswith(prefix):
+            return section[len(prefix):]
+    return section
+
+
+def read_profile(path, sections):
+    """Return ({function: samples}, total samples)."""
+    counts = {}
+    with open(path, "rb") as f:
+        data = f.read()
+
+    try:
+        text = data.decode("ascii")
+        lines = [l.split() for l in text.splitlines() if l.strip()]
+        if lines and all(len(l) >= 2 and l[0].isdigit() for l in lines):
+            for l in lines:
+                counts[l[1]] = counts.get(l[1], 0) + int(l[0])
+            return counts, sum(counts.values())
+    except UnicodeDecodeError:
+        pass
+
+    starts = [s[0] for s in sections]
+    total = 0
+    for (pc,) in struct.iter_unpack("<I", data[:len(data) & ~3]):
+        if pc == 0:
+            continue
+        pc &= ~1
+        total += 1
+        i = bisect.bisect_right(starts, pc) - 1
+        if i >= 0 and pc < sections[i][0] + sections[i][1]:
+            name = function_name(sections[i][2])
+        else:
+            name = "(other)"
+        counts[name] = counts.get(name, 0) + 1
+    return counts, total
+
+
+def rank(args):
+    sections = read_map(args.map)
+    counts, total = read_profile(args.profile, sections)
+    if not total:
+        sys.exit("%s: no samples" % args.profile)
+
+    sizes = {}
+    in_sram = set()
+    for addr, size, section, obj in sections:
+        name = function_name(section)
+        if section.startswith(SRAM_SECTION):
+            in_sram.add(name)
+        else:
+            sizes[name] = sizes.get(name, 0) + size
+
+    # Best samples per byte first, so the budget buys the most hits
+    candidates = [(counts[n] / sizes[n], n) for n in counts
+                  if n in sizes and n not in in_sram
+                  and counts[n] >= args.min_samples]
+    candidates.sort(reverse=True)
+
+    budget = args.budget * 1024
+    used = 0
+    chosen = []
+    for density, name in candidates:
+        if used + sizes[name] > budget:
+            continue
+        used += sizes[name]
+        chosen.append(name)
+
+    covered = sum(counts[n] for n in chosen)
+    with open(args.output, "w") as out:
+        out.write("# Generated by tools/hot_functions.py from %s\n"
+                  % args.profile)
+        out.write("# %d functions, %d bytes of %d, %.1f%% of %d samples\n"
+                  % (len(chosen), used, budget, 100.0 * covered / total, total))
+        for name in chosen:
+            out.write("%-40s # %6d bytes %6d samples\n"
+                      % (name, sizes[name], counts[name]))
+
+    already = sum(counts.get(n, 0) for n in in_sram)
+    print("%d functions, %d bytes, %.1f%% of samples (%.1f%% already in SRAM)"
+          % (len(chosen), used, 100.0 * covered / total,
+             100.0 * already / total))
+
+
+def read_list(path):
+    names = []
+    with open(path) as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if line:
+                names.append(line)
+    return names
+
+
+def place(args):
+    names = read_list(args.list) if args.list else []
+    renames = []
+    for name in names:
+        renames += ["--rename-section",
+                    "%s%s=%s%s" % (FLASH_SECTION, name, SRAM_SECTION, name)]
+    for obj in args.objects:
+        if not obj.endswith((".o", ".obj")):
+            continue
+        orig = obj + ".orig"
+        if not os.path.exists(orig):
+            if not renames:
+                continue
+            shutil.copy2(obj, orig)
+        elif os.stat(obj).st_mtime_ns != os.stat(orig).st_mtime_ns:
+            shutil.copy2(obj, orig)     # recompiled since the last run
+        # Sections an object doesn't have are ignored
+        subprocess.check_call([args.objcopy] + renames + [orig, obj])
+        # Give the object the compiler's time again, so that the next run
+        # can tell a recompile from its own output
+        st = os.stat(orig)
+        os.utime(obj, ns=(st.st_atime_ns, st.st_mtime_ns))
+
+
+def check(args):
+    names = read_list(args.list)
+    placed = {}
+    for addr, size, section, obj in read_map(args.map):
+        if section.startswith(SRAM_SECTION):
+            placed[function_name(section)] = placed.get(
+                function_name(section), 0) + size
+    missing = [n for n in names if n not in placed]
+    print("Hot functions: %d of %d in SRAM, %d bytes"
+          % (len(names) - len(missing), len(names),
+             sum(placed.get(n, 0) for n in names)))
+    for name in missing:
+        print("  not placed: %s" % name)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Profile-guided placement of hot functions into SRAM")
+    sub = parser.add_subparsers(dest="command")
+    sub.required = True
+
+    p = sub.add_parser("rank", help="pick hot functions from a profile")
+    p.add_argument("--map", required=True)
+    p.add_argument("--profile", required=True)
+    p.add_argument("--budget", type=int, default=16, help="KB of SRAM")
+    p.add_argument("--min-samples", type=int, default=2)
+    p.add_argument("-o", "--output", default="hot_functions.txt")
+    p.set_defaults(func=rank)
+
+    p = sub.add_parser("place", help="move listed functions to SRAM sections")
+    p.add_argument("--objcopy", required=True)
+    p.add_argument("--list", help="functions to place; none if left out")
+    p.add_argument("objects", nargs="*")
+    p.set_defaults(func=place)
+
+    p = sub.add_parser("check", help="verify placement in the map file")
+    p.add_argument("--map", required=True)
+    p.add_argument("--list", required=True)
+    p.set_defaults(func=check)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+# Convert a WAD to the LZ4 compressed "ZWAD" container read by w_lz4.c.
+#
+# Each lump that gets smaller is split into 32 KB pieces, and each piece
+# is written as an LZ4 block after a 32-bit length; matches may reach
+# back into earlier pieces of the same lump. Lumps that don't shrink are
+# stored as they are. The directory entries carry the packed size next
+# to the unpacked one, so the game still sees the original lumps.
+#
+# The python lz4 module is used for compression if it is installed,
+# otherwise a slower built-in compressor. Every lump is unpacked again
+# and compared before the file is written.
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import argparse
+import struct
+import sys
+
+try:
+    import lz4.block
+except ImportError:
+    lz4 = None
+
+BLOCK = 0x8000
+STORED = 0x80000000
+WINDOW = 0xffff
+MIN_MATCH = 4
+LAST_LITERALS = 5     # the last bytes of a block are always literals
+MF_LIMIT = 12         # and no match starts closer than this to the end
+
+
+def write_length(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def write_sequence(out, literals, offset, length):
+    lit = len(literals)
+    token = min(lit, 15) << 4
+    if offset:
+        token |= min(length - MIN_MATCH, 15)
+    out.append(token)
+    if lit >= 15:
+        write_length(out, lit - 15)
+    out += literals
+    if offset:
+        out += struct.pack("<H", offset)
+        if length - MIN_MATCH >= 15:
+            write_length(out, length - MIN_MATCH - 15)
+
+
+def compress_block(data, start, end, table):
+    """LZ4 block for data[start:end], with matches back into data[:start].
+
+    Greedy, with a hash of the last position of each 4-byte string kept
+    across the blocks of a lump.
+    """
+    out = bytearray()
+    anchor = i = start
+    limit = end - MF_LIMIT
+    match_end = end - LAST_LITERALS
+    while i < limit:
+        key = data[i:i + 4]
+        cand = table.get(key)
+        table[key] = i
+        if cand is None or i - cand > WINDOW:
+            i += 1
+            continue
+        j = i + MIN_MATCH
+        k = cand + MIN_MATCH
+        while j < match_end and data[j] == data[k]:
+            j += 1
+            k += 1
+        while i > anchor and cand > 0 and data[i - 1] == data[cand - 1]:
+            i -= 1
+            cand -= 1
+        write_sequence(out, data[anchor:i], i - cand, j - i)
+        if j - 2 > i:
+            table[data[j - 2:j + 2]] = j - 2
+        anchor = i = j
+    write_sequence(out, data[anchor:end], 0, 0)
+    return bytes(out)
+
+
+def compress_block_lz4(data, start, end, table):
+    prefix = data[max(0, start - WINDOW):start]
+    return lz4.block.compress(data[start:end], mode="high_compression",
+                              compression=12, store_size=False, dict=prefix)
+
+
+def decompress_block(src, out, length):
+    target = len(out) + length
+    i = 0
+    while i < len(src):
+        token = src[i]
+        i += 1
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                n = src[i]
+                i += 1
+                lit += n
+                if n != 255:
+                    break
+        out += src[i:i + lit]
+        i += lit
+        if i == len(src):
+            break
+        offset = src[i] | src[i + 1] << 8
+        i += 2
+        length = (token & 15) + MIN_MATCH
+        if token & 15 == 15:
+            while True:
+                n = src[i]
+                i += 1
+                length += n
+                if n != 255:
+                    break
+        if offset == 0 or offset > len(out):
+            raise ValueError("bad match offset")
+        for _ in range(length):
+            out.append(out[-offset])
+    if len(out) != target:
+        raise ValueError("block unpacks to the wrong size")
+
+
+def pack_lump(data, compress):
+    packed = bytearray()
+    table = {}
+    for start in range(0, len(data), BLOCK):
+        end = min(start + BLOCK, len(data))
+        block = compress(data, start, end, table)
+        if len(block) >= end - start:
+            packed += struct.pack("<I", (end - start) | STORED)
+            packed += data[start:end]
+        else:
+            packed += struct.pack("<I", len(block))
+            packed += block
+    return bytes(packed)
+
+
+def unpack_lump(packed, size):
+    out = bytearray()
+    i = 0
+    while len(out) < size:
+        header, = struct.unpack_from("<I", packed, i)
+        length = header & ~STORED
+        block = packed[i + 4:i + 4 + length]
+        i += 4 + length
+        if header & STORED:
+            out += block
+        else:
+            decompress_block(block, out, min(BLOCK, size - len(out)))
+    return bytes(out)
+
+
+def read_wad(path):
+    with open(path, "rb") as f:
+        wad = f.read()
+    ident, numlumps, dirofs = struct.unpack_from("<4sii", wad, 0)
+    if ident not in (b"IWAD", b"PWAD"):
+        sys.exit("%s: not a WAD file" % path)
+    lumps = []
+    for n in range(numlumps):
+        pos, size, name = struct.unpack_from("<ii8s", wad, dirofs + n * 16)
+        lumps.append((name, wad[pos:pos + size]))
+    return lumps
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert a WAD to the LZ4 compressed ZWAD container")
+    parser.add_argument("input", help="IWAD or PWAD")
+    parser.add_argument("output", help="ZWAD; may keep the .wad name")
+    parser.add_argument("--min-size", type=int, default=64,
+                        help="store lumps smaller than this as they are")
+    parser.add_argument("--builtin", action="store_true",
+                        help="use the built-in compressor even if lz4 is "
+                             "installed")
+    args = parser.parse_args()
+
+    if lz4 is not None and not args.builtin:
+        compress = compress_block_lz4
+    else:
+        compress = compress_block
+
+    lumps = read_wad(args.input)
+    body = bytearray()
+    directory = bytearray()
+    offset = 12
+    total = 0
+    cache = {}
+    for name, data in lumps:
+        packed = b""
+        if len(data) >= args.min_size:
+            if data not in cache:
+                p = pack_lump(data, compress)
+                if unpack_lump(p, len(data)) != data:
+                    sys.exit("%s: lump %s does not unpack"
+                             % (args.input, name.rstrip(b"\0").decode()))
+                cache[data] = p if len(p) < len(data) else b""
+            packed = cache[data]
+        stored = packed or data
+        directory += struct.pack("<iii8s", offset + len(body), len(packed),
+                                 len(data), name)
+        body += stored
+        total += len(data)
+
+    with open(args.output, "wb") as f:
+        f.write(struct.pack("<4sii", b"ZWAD", len(lumps),
+                            offset + len(body)))
+        f.write(body)
+        f.write(directory)
+
+    print("%d lumps, %d bytes packed to %d (%.1f%%)"
+          % (len(lumps), total, len(body), 100.0 * len(body) / max(total, 1)))
+
+
+if __name__ == "__main__":
+    main()